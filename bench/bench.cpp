@@ -0,0 +1,224 @@
+/*
+ *  Host benchmarks of the library's formatting, parsing and locale hot paths
+ *
+ *  Builds the unmodified headers against the Arduino core mock in mock/ and reports for each operation:
+ *      ns/op          time per operation (wall clock, steady_clock)
+ *      calls/op       writes to (or reads from) Serial per operation
+ *      stack          peak stack bytes the operation used (stack painting, minus the cost of an empty operation)
+ *
+ *  make run       builds and runs the benchmarks
+ *  make compare  also builds the shared benchmarks against the baseline library (BASE=<commit>, 76bde5e by default) and runs both
+ *  make test      runs the output checks in test.cpp
+ *  make tsan      runs osyncstream from several threads under ThreadSanitizer (threads.cpp)
+ *  make check     compiles the library with -Wall -Wextra as C++17 and as C++11 for AVR
+ *
+ *  The numbers are for comparing two versions of the library on the same machine, they don't say how fast a board is. The shared benchmarks use only the API that
+ *  the baseline library already had, the ones that need newer API (scientific, hex, timestamp, unitbuf, bounded, read_array, collkey, ...) are left out with -DBENCH_BASELINE.
+ *
+ */
+
+
+#include <Arduino.h> // the Arduino IDE includes it in sketches automatically
+#include <locale.hpp>
+#include <iostream.hpp>
+
+
+#define ITERATIONS 100000
+#define STACK_PROBE (64 * 1024)     // bytes below the caller that get painted before each stack measurement
+
+
+// ----- stack measurement -----
+
+static uintptr_t paintedBottom; // address only, so the compiler doesn't see a pointer to a dead local
+
+__attribute__ ((noinline)) static void paintStack () {
+    volatile uint8_t area [STACK_PROBE];
+    for (size_t i = 0; i < STACK_PROBE; i++)
+        area [i] = 0xA5;
+    paintedBottom = (uintptr_t) area;
+}
+
+// the deepest byte that isn't painted any more, scanning from the bottom so the frame of this function doesn't matter
+__attribute__ ((noinline)) static volatile uint8_t *deepestWrite () {
+    volatile uint8_t *p = (volatile uint8_t *) paintedBottom;
+    while (*p == 0xA5)
+        p++;
+    return p;
+}
+
+template<typename F>
+__attribute__ ((noinline)) static size_t stackBytes (F f) {
+    volatile uint8_t *top = (volatile uint8_t *) __builtin_frame_address (0);
+    paintStack ();
+    f (1);
+    return top - deepestWrite ();
+}
+
+static size_t stackBaseline;
+
+
+// ----- what the baseline library doesn't have -----
+
+// the baseline library writes straight to Serial and has no flush () or clear ()
+template<typename S> static auto flushStream (S& s, int) -> decltype (s.flush (), void ()) { s.flush (); }
+template<typename S> static void flushStream (S&, long) {}
+
+template<typename S> static auto clearStream (S& s, int) -> decltype (s.clear (), void ()) { s.clear (); }
+template<typename S> static void clearStream (S&, long) {}
+
+
+// ----- reporting -----
+
+template<typename F>
+static void bench (const char *name, F f, unsigned long& calls) {
+    flushStream (cout, 0);
+    unsigned long startCalls = calls;
+    auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < ITERATIONS; i++)
+        f (i);
+    flushStream (cout, 0);
+    double ns = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count () / ITERATIONS;
+    double callsPerOp = (double) (calls - startCalls) / ITERATIONS;
+    size_t stack = stackBytes (f);
+    flushStream (cout, 0);
+    printf ("   %-28s %9.1f ns/op %8.3f calls/op %6zu stack bytes\n", name, ns, callsPerOp, stack > stackBaseline ? stack - stackBaseline : 0);
+}
+
+template<typename F>
+static void benchOutput (const char *name, F f) { bench (name, f, Serial.writeCalls); }
+
+template<typename F>
+static void benchInput (const char *name, const char *script, F f) {
+    Serial.play (script);
+    clearStream (cin, 0);
+    bench (name, f, Serial.readCalls);
+}
+
+// sustained parsing rate of the same script
+template<typename F>
+static void benchRate (const char *name, const char *script, F f) {
+    Serial.play (script);
+    clearStream (cin, 0);
+    size_t bytes = strlen (script);
+    auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < ITERATIONS; i++)
+        f (i);
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    printf ("   %-28s %9.1f MB/s\n", name, (double) bytes * ITERATIONS / seconds / 1e6);
+}
+
+
+int main () {
+    stackBaseline = stackBytes ([] (int) {});
+
+    // ----- shared benchmarks, baseline API only -----
+
+    const char *manipulatorNames [] = { "default", "showpoint", "fixed, setprecision (2)" };
+    for (int m = 0; m < 3; m++) {
+        cout << noshowpoint << defaultfloat << setprecision (6);
+        switch (m) {
+            case 1: cout << showpoint; break;
+            case 2: cout << fixed << setprecision (2); break;
+        }
+        printf ("\ncout << value, %s:\n", manipulatorNames [m]);
+
+        benchOutput ("int", [] (int i) { cout << 1234567 * (i % 1000) << ' '; });
+        benchOutput ("int64_t", [] (int i) { cout << (int64_t) 1234567890123LL * i << ' '; });
+        benchOutput ("float", [] (int i) { cout << 3.14159f * i << ' '; });
+        benchOutput ("double", [] (int i) { cout << 2.718281828459045 * i << ' '; });
+        benchOutput ("struct tm", [] (int i) {
+            struct tm t = {};
+            t.tm_sec = i % 60;
+            t.tm_min = i % 60;
+            t.tm_hour = i % 24;
+            t.tm_mday = 1 + i % 28;
+            t.tm_mon = i % 12;
+            t.tm_year = 126;
+            cout << t << ' ';
+        });
+    }
+    cout << noshowpoint << defaultfloat << setprecision (6);
+
+    // sink calls of a chain that ends with endl
+    printf ("\ncout << ... << endl:\n");
+    benchOutput ("endl", [] (int i) { cout << "i = " << i << ", i * i = " << i * i << endl; });
+
+    printf ("\ncin >> value:\n");
+    benchInput ("int", "1234567 ", [] (int) { int v; cin >> v; });
+    benchInput ("long", "-1234567890 ", [] (int) { long v; cin >> v; });
+    benchInput ("float", "3.14159 ", [] (int) { float v; cin >> v; });
+    benchInput ("double", "2.718281828459045 ", [] (int) { double v; cin >> v; });
+    benchInput ("char *", "token ", [] (int) { char v [16]; cin >> v; });
+    benchInput ("String", "token ", [] (int) { String v; cin >> v; });
+
+    printf ("\ncin >> value, sustained:\n");
+    benchRate ("int", "1234567 -7654321 42 0 ", [] (int) { int v; cin >> v >> v >> v >> v; });
+    benchRate ("double", "2.718281828459045 -1e-7 ", [] (int) { double v; cin >> v >> v; });
+
+    const char *localeNames [] = { "ASCII", "en_150.UTF-8" };
+    for (int l = 0; l < 2; l++) {
+        setlocale (lc_all, localeNames [l]);
+        printf ("\nlocale %s:\n", localeNames [l]);
+
+        benchOutput ("grouped int", [] (int i) { cout << showpoint << 1234567 * (i % 1000) << noshowpoint << ' '; });
+        benchOutput ("grouped double", [] (int i) { cout << showpoint << 1234567.891 * i << noshowpoint << ' '; });
+        benchOutput ("strcoll", [] (int) { volatile int c = strcoll ("Luka Dončić", "Luka Doncic"); (void) c; });
+        benchOutput ("toupper", [] (int) {
+            char s [] = "Jožef Stefan was a Carinthian Slovene physicist";
+            toupper (s);
+        });
+    }
+    setlocale (lc_all, "ASCII");
+
+    #ifndef BENCH_BASELINE
+
+        // ----- API that the baseline library doesn't have -----
+
+        const char *newManipulatorNames [] = { "scientific", "hex" };
+        for (int m = 0; m < 2; m++) {
+            cout << noshowpoint << defaultfloat << setprecision (6) << dec;
+            switch (m) {
+                case 0: cout << scientific; break;
+                case 1: cout << hex; break;
+            }
+            printf ("\ncout << value, %s:\n", newManipulatorNames [m]);
+
+            benchOutput ("int", [] (int i) { cout << 1234567 * (i % 1000) << ' '; });
+            benchOutput ("long long", [] (int i) { cout << 1234567890123LL * i << ' '; });
+            benchOutput ("float", [] (int i) { cout << 3.14159f * i << ' '; });
+            benchOutput ("double", [] (int i) { cout << 2.718281828459045 * i << ' '; });
+        }
+        cout << noshowpoint << defaultfloat << setprecision (6) << dec;
+
+        printf ("\ncout << time:\n");
+        benchOutput ("timestamp", [] (int i) { cout << timestamp (1761600424 + i) << ' '; });
+        benchOutput ("uptime", [] (int i) { cout << uptime (i * 1001ul) << ' '; });
+
+        printf ("\ncout << ... << endl, buffered:\n");
+        benchOutput ("flushOnEndl", [] (int i) { cout << "i = " << i << ", i * i = " << i * i << endl; });
+        cout << unitbuf;
+        benchOutput ("unitbuf", [] (int i) { cout << "i = " << i << ", i * i = " << i * i << endl; });
+        cout << flushOnEndl;
+
+        printf ("\ncin >> value, new API:\n");
+        benchInput ("long long", "-1234567890123 ", [] (int) { long long v; cin >> v; });
+        benchInput ("bounded (char [16])", "token ", [] (int) { char v [16]; cin >> bounded (v); });
+        benchInput ("read_array <int> [16]", "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16 ", [] (int) { int v [16]; cin.read_array (v, 16); });
+        benchRate ("read_array <float> [8]", "1.5,2.5,3.5,4.5,5.5,6.5,7.5,8.5 ", [] (int) { float v [8]; cin.read_array (v, 8); });
+
+        for (int l = 0; l < 2; l++) {
+            setlocale (lc_all, localeNames [l]);
+            printf ("\nlocale %s, new API:\n", localeNames [l]);
+
+            benchOutput ("collkey", [] (int) {
+                char key [128];
+                volatile size_t n = collkey (key, "Luka Dončić", sizeof (key));
+                (void) n;
+            });
+        }
+        setlocale (lc_all, "ASCII");
+
+    #endif
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ *  Arduino.h mock for building the library on the host (Linux), used by the benchmarks in bench/
+ *
+ *  Only what the library needs: Serial, Print, Stream, String, millis, micros, delay, yield, dtostrf and PROGMEM access.
+ *  Serial counts the calls of its write, read and readBytes functions, and its input plays a script over and over.
+ *
+ */
+
+
+#ifndef __ARDUINO_H_MOCK__
+    #define __ARDUINO_H_MOCK__
+
+    #include <stdint.h>
+    #include <stddef.h>
+    #include <stdlib.h>
+    #include <stdio.h>
+    #include <string.h>
+    #include <math.h>
+    #include <time.h>
+    #include <string>
+    #include <chrono>
+    #include <thread>
+
+    #define PROGMEM
+    #define pgm_read_byte(p) (*(const uint8_t *) (p))
+    #define pgm_read_word(p) (*(const uint16_t *) (p))
+    #define memcpy_P memcpy
+
+    #define DEC 10
+    #define HEX 16
+    #define OCT 8
+    #define BIN 2
+
+    inline unsigned long millis () { using namespace std::chrono; static auto start = steady_clock::now (); return (unsigned long) duration_cast<milliseconds> (steady_clock::now () - start).count (); }
+    inline unsigned long micros () { using namespace std::chrono; static auto start = steady_clock::now (); return (unsigned long) duration_cast<microseconds> (steady_clock::now () - start).count (); }
+    inline void delay (unsigned long ms) { std::this_thread::sleep_for (std::chrono::milliseconds (ms)); }
+    inline void yield () { std::this_thread::yield (); }
+
+    inline char *dtostrf (double value, signed char width, unsigned char precision, char *buf) {
+        sprintf (buf, "%*.*f", width, precision, value);
+        return buf;
+    }
+
+    class String {
+        public:
+            String (const char *s = "") : __s__ (s) {}
+            inline const char *c_str () const { return __s__.c_str (); }
+            inline unsigned int length () const { return (unsigned int) __s__.length (); }
+            inline bool operator == (const char *s) const { return __s__ == s; }
+        private:
+            std::string __s__;
+    };
+
+    class Print {
+        public:
+            virtual ~Print () {}
+            virtual size_t write (uint8_t c) = 0;
+            virtual size_t write (const uint8_t *buf, size_t len) { size_t n = 0; while (len --) n += write (*buf ++); return n; }
+            virtual int availableForWrite () { return 0; }
+
+            inline size_t print (const char *s) { return write ((const uint8_t *) s, strlen (s)); }
+            inline size_t print (const String& s) { return print (s.c_str ()); }
+            inline size_t print (char c) { return write ((uint8_t) c); }
+            inline size_t print (unsigned char value, int base = DEC) { return print ((unsigned long) value, base); }
+            inline size_t print (int value, int base = DEC) { return print ((long) value, base); }
+            inline size_t print (unsigned int value, int base = DEC) { return print ((unsigned long) value, base); }
+            inline size_t print (long value, int = DEC) { char buf [24]; snprintf (buf, sizeof (buf), "%ld", value); return print (buf); }
+            inline size_t print (unsigned long value, int = DEC) { char buf [24]; snprintf (buf, sizeof (buf), "%lu", value); return print (buf); }
+            inline size_t print (double value, int digits = 2) { char buf [400]; snprintf (buf, sizeof (buf), "%.*f", digits, value); return print (buf); }
+    };
+
+    class Stream : public Print {
+        public:
+            virtual int available () = 0;
+            virtual int read () = 0;
+            virtual size_t readBytes (char *buf, size_t len) { size_t n = 0; while (n < len && available () > 0) buf [n ++] = (char) read (); return n; }
+    };
+
+    class MockSerial : public Stream {
+        public:
+            unsigned long writeCalls = 0;   // sink calls
+            unsigned long bytesWritten = 0;
+            unsigned long readCalls = 0;
+            const char *script = "";        // input, played over and over
+
+            inline void begin (unsigned long) {}
+            inline explicit operator bool () const { return true; }
+
+            size_t write (uint8_t) override { writeCalls ++; bytesWritten ++; return 1; }
+            size_t write (const uint8_t *, size_t len) override { writeCalls ++; bytesWritten += len; return len; }
+            int availableForWrite () override { return 1 << 30; }
+
+            int available () override { return *script ? 1 << 20 : 0; }
+            int read () override {
+                readCalls ++;
+                if (!*script)
+                    return -1;
+                char c = script [__position__ ++];
+                if (!script [__position__])
+                    __position__ = 0;
+                return (unsigned char) c;
+            }
+            size_t readBytes (char *buf, size_t len) override {
+                readCalls ++;
+                size_t n = 0;
+                while (n < len && *script) {
+                    size_t chunk = strlen (script + __position__);
+                    if (chunk > len - n)
+                        chunk = len - n;
+                    memcpy (buf + n, script + __position__, chunk);
+                    n += chunk;
+                    __position__ += chunk;
+                    if (!script [__position__])
+                        __position__ = 0;
+                }
+                return n;
+            }
+
+            inline void play (const char *s) { script = s; __position__ = 0; }
+
+        private:
+            size_t __position__ = 0;
+    };
+
+    #if __cplusplus >= 201703L
+        inline MockSerial Serial;
+    #else
+        static MockSerial Serial;
+    #endif
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ *  Host checks of the library's output formatting
+ *
+ *  Builds the unmodified headers against the Arduino core mock in mock/, formats values into an ostringstream and compares the text with the expected one.
+ *
+ *  make test    builds and runs the checks, the exit code is the number of failed ones
+ *
+ */
+
+
+#include <Arduino.h> // the Arduino IDE includes it in sketches automatically
+#include <locale.hpp>
+#include <iostream.hpp>
+#include <sstream.hpp>
+
+
+static int failures = 0;
+
+// formats with f into a fresh ostringstream and compares the result
+template<typename F>
+static void expect (const char *expected, F f) {
+    fixed_ostringstream<128> os;
+    f (os);
+    if (strcmp (os.c_str (), expected)) {
+        printf ("   expected \"%s\", got \"%s\"\n", expected, os.c_str ());
+        failures ++;
+    }
+}
+
+
+int main () {
+
+    // ----- setw with floating point values -----
+
+    printf ("setw with floating point values\n");
+    expect ("       3.5", [] (ostream& os) { os << setw (10) << 3.5; });
+    expect ("3.5*******", [] (ostream& os) { os << left << setfill ('*') << setw (10) << 3.5; });
+    expect ("    -0.001", [] (ostream& os) { os << setw (10) << -0.001; });
+    expect ("     1e+21", [] (ostream& os) { os << setw (10) << 1e21; });
+    expect ("      3.50", [] (ostream& os) { os << setw (10) << fixed << setprecision (2) << 3.5; });
+    expect ("0003.50", [] (ostream& os) { os << setfill ('0') << setw (7) << fixed << setprecision (2) << 3.5f; });
+    expect ("     10.00", [] (ostream& os) { os << setw (10) << fixed << setprecision (2) << 9.999; });
+    expect (" 1,234,567.89", [] (ostream& os) { os << showpoint << setw (13) << fixed << setprecision (2) << 1234567.891; });
+    expect ("-0.12|", [] (ostream& os) { os << setw (3) << fixed << setprecision (2) << -0.123 << '|'; });
+    expect ("  3.50e+00", [] (ostream& os) { os << setw (10) << scientific << setprecision (2) << 3.5; });
+    expect ("1.00e+01  |", [] (ostream& os) { os << left << setw (10) << scientific << setprecision (2) << 9.999 << '|'; });
+    expect ("   -1.0e-100", [] (ostream& os) { os << setw (12) << scientific << setprecision (1) << -1e-100; });
+    expect ("  0.00e+00", [] (ostream& os) { os << setw (10) << scientific << setprecision (2) << 0.0; });
+    expect ("       inf", [] (ostream& os) { os << setw (10) << 1.0 / 0.0; });
+    expect ("3.5|3.5", [] (ostream& os) { os << setw (2) << 3.5 << '|' << 3.5; }); // the width applies only to the next value
+
+    printf ("%d failed\n", failures);
+    return failures;
+}
@@ -0,0 +1,99 @@
+/*
+ *  Host check of osyncstream with several threads, meant to be built with ThreadSanitizer
+ *
+ *  Each thread writes its lines through its own osyncstream, with its own manipulators, into an asynchronous basic_ostream that gets serviced by the main thread
+ *  through its osyncqueue, like loop () would service cout through coutSyncQueue. Afterwards every line has to be there, in order within its thread and intact.
+ *
+ *  make tsan    builds and runs the check with -fsanitize=thread, the exit code is the number of bad lines
+ *
+ */
+
+
+#include <Arduino.h> // the Arduino IDE includes it in sketches automatically
+#include <iostream.hpp>
+#include <osyncstream.hpp>
+#include <sstream.hpp>
+#include <thread>
+#include <atomic>
+
+
+#define THREADS 8
+#define LINES 1000 // per thread
+
+
+// records the output and accepts only a few bytes at a time, so the output queue keeps filling up
+struct Recorder {
+    std::string text;
+    inline size_t write (const uint8_t *buf, size_t len) { text.append ((const char *) buf, len); return len; }
+    inline int availableForWrite () { return 16; }
+};
+
+static Recorder recorder;
+static basic_ostream<Recorder, 64, 256> out (recorder);
+static osyncqueue outQueue (out);
+
+// the same line for the threads and for the check
+static void formatLine (ostream& os, int thread, int line) {
+    os << "thread " << thread << " line " << setw (4) << setfill ('0') << line << setfill (' ') << ": ";
+    switch (thread % 3) {
+        case 0: os << fixed << setprecision (2) << line * 0.25; break;
+        case 1: os << scientific << setprecision (3) << line * 1e-3; break;
+        default: os << hex << showbase << line * 4099 << dec; break;
+    }
+    os << ' ' << timestamp (1761600424 + line * 61);
+}
+
+
+int main () {
+    std::atomic<int> running { THREADS };
+    std::thread threads [THREADS];
+    for (int t = 0; t < THREADS; t++)
+        threads [t] = std::thread ([t, &running] {
+            osyncstream os (outQueue);
+            for (int i = 0; i < LINES; i++) {
+                formatLine (os, t, i);
+                os << endl;
+            }
+            os.flush ();
+            running --;
+        });
+    while (running) // the task that owns out
+        outQueue.service ();
+    for (int t = 0; t < THREADS; t++)
+        threads [t].join ();
+    outQueue.service ();
+    while (out.pending ())
+        out.service ();
+
+    // every line in the order of its thread
+    int bad = 0;
+    int next [THREADS] = {};
+    const char *p = recorder.text.c_str ();
+    while (*p) {
+        const char *end = strstr (p, "\r\n");
+        if (!end)
+            end = p + strlen (p);
+        std::string line (p, end - p);
+        p = *end ? end + 2 : end;
+        int t;
+        if (sscanf (line.c_str (), "thread %d", &t) != 1 || t < 0 || t >= THREADS || next [t] >= LINES) {
+            printf ("   unexpected line: %s\n", line.c_str ());
+            bad ++;
+            continue;
+        }
+        fixed_ostringstream<__OSYNCSTREAM_LINE_SIZE__> expected;
+        formatLine (expected, t, next [t] ++);
+        if (line != expected.c_str ()) {
+            printf ("   expected \"%s\", got \"%s\"\n", expected.c_str (), line.c_str ());
+            bad ++;
+        }
+    }
+    for (int t = 0; t < THREADS; t++)
+        if (next [t] != LINES) {
+            printf ("   thread %d: %d of %d lines\n", t, next [t], LINES);
+            bad ++;
+        }
+
+    printf ("%d threads, %d lines, %d bad\n", THREADS, THREADS * LINES, bad);
+    return bad;
+}
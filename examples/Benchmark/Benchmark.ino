@@ -0,0 +1,138 @@
+#include <locale.hpp>
+#include <iostream.hpp>
+
+
+/*
+
+    Measures the formatting, parsing and locale hot paths of the library on the board itself. Each line
+    reports the time per operation and, for output, how many times per operation the stream wrote to its
+    device. Run it before and after a change to catch regressions. bench/ in the repository runs the same
+    measurements (and stack usage) on a Linux host against a mocked Arduino core.
+
+*/
+
+
+#define ITERATIONS 1000
+
+
+// output device that discards everything but counts the writes
+class nullDevice {
+    public:
+        unsigned long writes = 0;
+        unsigned long bytes = 0;
+
+        size_t write (const uint8_t *, size_t len) {
+            writes ++;
+            bytes += len;
+            return len;
+        }
+};
+
+// input device that plays the same script over and over
+class scriptedDevice {
+    public:
+        const char *script = "";
+        size_t position = 0;
+
+        int available () { return strlen (script + position); }
+
+        int readBytes (char *buf, int len) {
+            int n = 0;
+            while (n < len && script [position]) {
+                buf [n ++] = script [position ++];
+                if (!script [position])
+                    position = 0; // start over
+            }
+            return n;
+        }
+};
+
+nullDevice sink;
+basic_ostream<nullDevice> out (sink);
+
+scriptedDevice source;
+basic_istream<scriptedDevice> in (source);
+
+
+// runs f ITERATIONS times and reports ns/op and writes/op
+template<typename F>
+void benchmark (const char *name, F f) {
+    out.flush ();
+    sink.writes = 0;
+    unsigned long start = micros ();
+    for (int i = 0; i < ITERATIONS; i++)
+        f (i);
+    out.flush ();
+    unsigned long duration = micros () - start;
+    cout << "   " << name << ": " << (float) duration * 1000 / ITERATIONS << " ns/op, " << (float) sink.writes / ITERATIONS << " writes/op" << endl;
+}
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    // ----- cout << -----
+
+    const char *manipulatorNames [] = { "default", "showpoint", "fixed, setprecision (2)" };
+    for (int m = 0; m < 3; m++) {
+        switch (m) {
+            case 0: out << noshowpoint << defaultfloat << setprecision (6); break;
+            case 1: out << showpoint << defaultfloat << setprecision (6); break;
+            case 2: out << noshowpoint << fixed << setprecision (2); break;
+        }
+        cout << "\nout << value, " << manipulatorNames [m] << ":" << endl;
+
+        benchmark ("int", [] (int i) { out << 1234567 * i << ' '; });
+        benchmark ("long long", [] (int i) { out << 1234567890123LL * i << ' '; });
+        benchmark ("float", [] (int i) { out << 3.14159f * i << ' '; });
+        benchmark ("double", [] (int i) { out << 2.718281828459045 * i << ' '; });
+        benchmark ("struct tm", [] (int i) {
+            struct tm t = {};
+            t.tm_sec = i % 60;
+            t.tm_min = i % 60;
+            t.tm_hour = i % 24;
+            t.tm_mday = 1 + i % 28;
+            t.tm_mon = i % 12;
+            t.tm_year = 126;
+            out << t << ' ';
+        });
+        benchmark ("timestamp", [] (int i) { out << timestamp (1761600424 + i) << ' '; });
+        benchmark ("uptime", [] (int i) { out << uptime (i * 1001ul) << ' '; });
+    }
+    out << noshowpoint << defaultfloat << setprecision (6);
+
+    // ----- cin >> -----
+
+    cout << "\nin >> value:" << endl;
+
+    source.script = "1234567 ";
+    benchmark ("int", [] (int) { int v; in >> v; });
+    source.script = "-1234567890123 ";
+    source.position = 0;
+    benchmark ("long long", [] (int) { long long v; in >> v; });
+    source.script = "3.14159 ";
+    source.position = 0;
+    benchmark ("float", [] (int) { float v; in >> v; });
+    source.script = "2.718281828459045 ";
+    source.position = 0;
+    benchmark ("double", [] (int) { double v; in >> v; });
+
+    // ----- locales -----
+
+    const char *localeNames [] = { "ASCII", "en_150.UTF-8" };
+    for (int l = 0; l < 2; l++) {
+        setlocale (lc_all, localeNames [l]);
+        cout << "\nlocale " << localeNames [l] << ":" << endl;
+
+        benchmark ("strcoll", [] (int) { volatile int c = strcoll ("Luka Dončić", "Luka Doncic"); (void) c; });
+        benchmark ("toupper", [] (int) {
+            char s [] = "Jožef Stefan was a Carinthian Slovene physicist";
+            toupper (s);
+        });
+    }
+    setlocale (lc_all, "ASCII");
+}
+
+void loop () {
+
+}
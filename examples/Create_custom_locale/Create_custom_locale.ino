@@ -28,94 +28,27 @@ class sl_SI_UTF_8_locale : public locale {
         // 2️⃣ override locale name
         const char* name () const override { return "sl_SI.UTF-8"; } 
 
-        // 3️⃣ override strcoll function that lc_collate would use with your own
-        int charorder (const utf8char& u8c) {
-            // Expand spacing between ASCII codes by multiplying each code by 3,
-            // allowing room to insert up to two additional characters between any pair (e.g., between 'C' and 'D').
-            if ((unsigned char) *u8c.c_str < 0x80) // 1 byte UTF-8 character = ASCII character
-                return  3 * *u8c.c_str;
-            else // multi-byte UTF-8 character
-                     if (u8c == utf8char ("Č")) return 3 * 'C' + 1;
-                else if (u8c == utf8char ("č")) return 3 * 'c' + 1;
-                else if (u8c == utf8char ("Ć")) return 3 * 'C' + 2;
-                else if (u8c == utf8char ("ć")) return 3 * 'c' + 2;
-                else if (u8c == utf8char ("Đ")) return 3 * 'D' + 1;
-                else if (u8c == utf8char ("đ")) return 3 * 'd' + 1;
-                else if (u8c == utf8char ("Š")) return 3 * 'S' + 1;
-                else if (u8c == utf8char ("š")) return 3 * 's' + 1;
-                else if (u8c == utf8char ("Ž")) return 3 * 'Z' + 1;
-                else if (u8c == utf8char ("ž")) return 3 * 'z' + 1;
-            return 3 * *u8c.c_str; // unhandeled UTF-8 character
+        // 3️⃣ override getCollationTable function that lc_collate (strcoll, collkey and collsort) would use with your own
+        const collationWeight *getCollationTable (size_t& count) const override {
+            // 4️⃣ list only the characters that don't sort by their code point, sorted by code point. The default weight of a character
+            //    is 4 * its code point, which leaves room for inserting up to three additional characters between any pair (e.g. between 'C' and 'D').
+            static const collationWeight table [] = {
+                { 0x0106 /* Ć */, 4 * 'C' + 2 }, { 0x0107 /* ć */, 4 * 'c' + 2 },
+                { 0x010C /* Č */, 4 * 'C' + 1 }, { 0x010D /* č */, 4 * 'c' + 1 },
+                { 0x0110 /* Đ */, 4 * 'D' + 1 }, { 0x0111 /* đ */, 4 * 'd' + 1 },
+                { 0x0160 /* Š */, 4 * 'S' + 1 }, { 0x0161 /* š */, 4 * 's' + 1 },
+                { 0x017D /* Ž */, 4 * 'Z' + 1 }, { 0x017E /* ž */, 4 * 'z' + 1 }
+            };
+            count = sizeof (table) / sizeof (table [0]);
+            return table;
         }
 
-        int strcoll (const char *s1, const char *s2) {
-            utf8_iterator it1 (s1); // 4️⃣ use utf8_iterators to iterate through strings of characters
-            utf8_iterator end1 = utf8_iterator (s1 + strlen (s1));
-            utf8_iterator it2 (s2);
-            utf8_iterator end2 = utf8_iterator (s2 + strlen (s2));
-
-            while (it1 <= end1 && it2 <= end2) { // please note that this includes the ending 0
-                if (charorder (*it1) < charorder (*it2))
-                    return -1; // s1 < s2
-                else if (charorder (*it1) > charorder (*it2))
-                    return 1; // s1 > s2
-                ++it1;
-                ++it2;
-            }
-
-            return 0; // s1 == s2
-        }
+        // 5️⃣ override getToUpperTable and getToLowerTable functions that lc_ctype (toupper and tolower) would use, Č, Ć, Đ, Š and Ž are already
+        //    covered by the built-in Latin-1 and Latin Extended-A tables, but you can provide your own tables of caseMapping ranges as well
+        const caseMapping *getToUpperTable (size_t& count) const override { count = sizeof (latinToUpper) / sizeof (latinToUpper [0]); return latinToUpper; }
+        const caseMapping *getToLowerTable (size_t& count) const override { count = sizeof (latinToLower) / sizeof (latinToLower [0]); return latinToLower; }
 
-        // 5️⃣ override toupper and tolower functions that lc_ctype would use with your own
-        bool toupper (char* ps) {
-            utf8_iterator end = utf8_iterator (ps + strlen (ps));
-            for (utf8_iterator it (ps) /* begin */; it < end; ++it) { // 6️⃣ use utf8_iterator to iterate through string of characters
-
-                if ((unsigned char) *(it.get ()) < 0x80) { // 1 byte UTF-8 character = ASCII character
-                    if (*(it.get ()) >= 'a' && *(it.get ()) <= 'z')
-                        *(it.get ()) = (*(it.get ()) - ('a' - 'A'));
-                } else { // multi-byte UTF-8 character
-                    // please note that the substitution like this works only when upper case letters occupy the same number of bytes as lower case letters
-                    if (*it == utf8char ("č"))
-                        it.set (utf8char ("Č"));
-                    else if (*it == utf8char ("ć"))
-                        it.set (utf8char ("Ć"));
-                    else if (*it == utf8char ("đ"))
-                        it.set (utf8char ("Đ"));
-                    else if (*it == utf8char ("š"))
-                        it.set (utf8char ("Š"));
-                    else if (*it == utf8char ("ž"))
-                        it.set (utf8char ("Ž"));
-                }
-
-            }
-            return true;
-        }
-
-        bool tolower (char* ps) {
-            utf8_iterator end = utf8_iterator (ps + strlen (ps));
-            for (utf8_iterator it (ps) /* begin */; it < end; ++it) {
-
-                if ((unsigned char) *(it.get ()) < 0x80) { // 1 byte UTF-8 character = ASCII character
-                    if (*(it.get ()) >= 'A' && *(it.get ()) <= 'Z')
-                        *(it.get ()) = (*(it.get ()) + ('a' - 'A'));
-                } else { // multi-byte UTF-8 character
-                    // please note that the substitution like this works only when lower case letters occupy the same number of bytes as upper case letters
-                    if (*it == utf8char ("Č"))
-                        it.set (utf8char ("č"));
-                    else if (*it == utf8char ("Ć"))
-                        it.set (utf8char ("ć"));
-                    else if (*it == utf8char ("Đ"))
-                        it.set (utf8char ("đ"));
-                    else if (*it == utf8char ("Š"))
-                        it.set (utf8char ("š"));
-                    else if (*it == utf8char ("Ž"))
-                        it.set (utf8char ("ž"));
-                }
-
-            }
-            return true;
-        }
+        // 6️⃣ or override toupper and tolower functions themselves if case conversion of your language needs more than that
 
         // 7️⃣ override getDecimalSeparator and getThousandsSeparator functions that lc_numeric would use with your own
         char getDecimalSeparator () const override { return ','; }
@@ -124,14 +57,15 @@ class sl_SI_UTF_8_locale : public locale {
         // 8️⃣ override getTimeFormat function that lc_time would use with your own
         const char* getTimeFormat () const override { return "%d.%m.%Y %H:%M:%S"; }
 };
-// 9️⃣ Create a working instance of your class and insert it into supported locale list
-bool __sl_SI_UTF_8_locale__ = addlocale (new sl_SI_UTF_8_locale);
+// 9️⃣ Create a working instance of your class and insert it into supported locale registry (no heap is needed, just declare it)
+sl_SI_UTF_8_locale slovenianLocale;
+bool __sl_SI_UTF_8_locale__ = addlocale (&slovenianLocale);
 
 
 void setup () {
     cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
 
-    setlocale (lc_all, "sl_SI.UTF-8"); // 🔟 call setlocale to choose the locale you just have created
+    setlocale (lc_all, "sl_SI.UTF-8"); // 🔟 call setlocale to choose the locale you just have created (or look up its ID once with localeid ("sl_SI.UTF-8") and then call setlocale (lc_all, id))
 
     // lc_ctype
 
@@ -143,17 +77,9 @@ void setup () {
     // lc_collate
 
     String athlet [] = { "Luka Dončić", "Tadej Pogačar", "Anže Kopitar", "Primož Rogljič" };
-    // Sort
+    // Sort (each name is transformed into its sort key only once)
     int n = sizeof (athlet) / sizeof (athlet [0]);
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = i; j < n; j++) {
-            if (strcoll (athlet [i], athlet [j]) > 0) {
-                String tmp = athlet [i];
-                athlet [i] = athlet [j];
-                athlet [j] = tmp;
-            }
-        }
-    }
+    collsort (athlet, n);
     cout << "\nSorted athlets:\n";
     for (int i = 0; i < n; i++)
         cout << "   " << athlet [i] << endl;
@@ -0,0 +1,38 @@
+#include <iostream.hpp>
+
+
+/*
+
+    Loads a table of coefficients sent over Serial, for example pasted into Serial Monitor:
+
+        0.9981, 1.0004, 1.0012; 0.9975
+        1.0021 1.0008 ...
+
+    read_array parses the values as they arrive, directly into the array, without collecting them in
+    another buffer first. Values may be separated by white spaces, commas or semicolons.
+
+*/
+
+
+#define COEFFICIENTS 16
+
+float coefficient [COEFFICIENTS];
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    cout << "Please send " << COEFFICIENTS << " calibration coefficients." << endl;
+
+    arrayReadResult result = cin.read_array (coefficient, COEFFICIENTS);
+    if (result.firstError >= 0) {
+        cout << COEFFICIENTS - result.count << " coefficient(s) could not be parsed, the first one is #" << result.firstError << endl;
+        cin.clear ();
+    }
+
+    cout << "Calibration table: " << coefficient << endl;
+}
+
+void loop () {
+
+}
@@ -0,0 +1,24 @@
+#include <iostream.hpp>
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    cout << "Please enter integer numbers while the loop keeps running." << endl;
+}
+
+void loop () {
+    static int i;
+
+    // try_read takes whatever has arrived so far and returns immediately, partially typed number is kept until the next call
+    switch (cin.try_read (i)) {
+        case ready:         cout << "You entered " << i << "." << endl;
+                            break;
+        case parseError:    cout << "This is not an integer number." << endl;
+                            break;
+        case wouldBlock:    // nothing complete yet, do some other work meanwhile
+                            break;
+    }
+
+    delay (100); // other work
+}
@@ -0,0 +1,46 @@
+#include <iostream.hpp>
+
+
+/*
+
+    Reads commands like "led 13 on" without copying the tokens around and without risking buffer overflows:
+    tokenView points into the stream's own buffers, bounded () never writes past the end of the buffer and
+    getline () reads the rest of the line.
+
+*/
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    cout << "Commands: led <pin> on|off, name <name>, echo <text>" << endl;
+}
+
+void loop () {
+    char line [48];
+    tokenView command;
+
+    cin >> command; // valid only until the next read from cin, compare it right away
+    if (command.length == 3 && !strncmp (command.data, "led", 3)) {
+        int pin;
+        char state [4];
+        cin >> pin >> bounded (state);
+        if (cin)
+            cout << "LED on pin " << pin << " turned " << state << endl;
+    } else if (command.length == 4 && !strncmp (command.data, "name", 4)) {
+        char name [16];
+        cin >> bounded (name);
+        if (cin)
+            cout << "Hello " << name << endl;
+        else
+            cout << "Name too long, only " << name << " fits" << endl;
+    } else if (command.length == 4 && !strncmp (command.data, "echo", 4)) {
+        cin.getline (line, sizeof (line));
+        cout << line << endl;
+        return;
+    } else {
+        cout << "Unknown command ";
+        cout.write (command.data, command.length) << endl;
+    }
+    cin.clear ();
+}
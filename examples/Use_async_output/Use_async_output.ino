@@ -0,0 +1,27 @@
+// with the output queue defined cout never waits for Serial: flushed output is queued in RAM and service () sends it only as fast as Serial can accept it
+#define __OSTREAM_QUEUE_SIZE__ 256
+#include <ostream.hpp>
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    // what to do when logging is faster than Serial and the queue gets full: blockWhenFull (default), dropNewest, dropOldest or markDropped
+    cout << markDropped;
+}
+
+void loop () {
+    static unsigned long lastLog = 0;
+
+    // a burst of logging only costs the formatting time, the control loop keeps running
+    if (millis () - lastLog >= 1000) {
+        lastLog = millis ();
+        for (int i = 0; i < 10; i++)
+            cout << "millis () = " << millis () << ", sample " << i << " = " << analogRead (A0) << endl;
+    }
+
+    cout.service (); // sends as much of the queued output as Serial can accept without blocking, call it from the same task that writes to cout, not from a background task
+                     // (when tasks write through osyncstream call coutSyncQueue.service () instead, it is safe from any task)
+
+    // ... control loop
+}
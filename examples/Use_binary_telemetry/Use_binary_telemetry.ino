@@ -0,0 +1,35 @@
+#include <obinstream.hpp>
+
+
+/*
+
+    cout << binary << a << b << c; writes one record with a, b and c encoded instead of formatted. Integers are written as varints,
+    floats as 4 bytes, the record is followed by its CRC, encoded with COBS and terminated by 0. On the receiving side collect the
+    bytes up to the next 0 and decode them with obinDecode:
+
+        uint8_t record [__OBINSTREAM_RECORD_SIZE__ + 2];
+        int len = obinDecode (frame, frameLength, record);
+        if (len >= 0) {
+            const uint8_t *p = record;
+            unsigned long t = obinReadVarint (p);
+            long sample = obinReadZigzag (p);
+            float voltage = obinReadFloat (p);
+        }
+
+*/
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+}
+
+void loop () {
+    long sample = analogRead (A0) - 512;
+    float voltage = sample * 5.0 / 1024;
+
+    // the same line in text mode would be: cout << millis () << ' ' << sample << ' ' << voltage << endl;
+    cout << binary << millis () << sample << voltage;
+    cout.flush ();
+
+    delay (10);
+}
@@ -0,0 +1,28 @@
+#include <ostream.hpp>
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    // by default cout collects the whole line in its internal buffer and writes it to Serial with a single call when endl (or '\n') is reached
+    cout << "Temperature of the Sun's photosphere is " << 5430 << " ℃" << endl;
+
+    // flushWhenFull writes to Serial only when the buffer gets full or when flush is written
+    cout << flushWhenFull;
+    for (int i = 1; i <= 10; i++)
+        cout << i << (i < 10 ? ", " : "\n");
+    cout << flush;
+
+    // unitbuf writes to Serial after each << operation, the way Serial.print does
+    cout << unitbuf << "Each << operation is written immediately." << endl;
+
+    // flushOnIdle writes to Serial when the buffer gets full, on flush or when idle () finds out that nothing has been written for a while
+    cout << flushOnIdle;
+}
+
+void loop () {
+    cout << "millis () = " << millis () << endl;
+    delay (1000);
+
+    cout.idle (); // with flushOnIdle policy this writes what has been collected in the buffer so far
+}
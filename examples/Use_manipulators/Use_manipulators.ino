@@ -15,6 +15,32 @@ void setup () {
     cout << fixed << setprecision (6) << showpoint;
     cout << "   Temperature of the Sun's photosphere is " <<  5430 << " ℃\n";
     cout << "   Stefan-Boltzmann constant is " << 5.670374419 << " · 10⁻⁸ [W·m⁻²·K⁻⁴]\n";
+
+
+    cout << "\nWith compile-time formatting (cout settings are not affected):\n";
+
+    cout << "   Stefan-Boltzmann constant is " << formatted<fixed, 3> (5.670374419) << " · 10⁻⁸ [W·m⁻²·K⁻⁴]\n";
+    cout << "   Speed of light is " << formatted<defaultfloat, 6, showpoint> (299792458) << " m/s\n";
+    cout << "   Avogadro constant is " << formatted<scientific, 4> (6.02214076e23) << " mol⁻¹\n";
+
+
+    cout << "\nArrays and containers:\n";
+
+    cout << defaultfloat << noshowpoint;
+    float measurements [] = { 21.5, 21.75, 22.0, 22.25 };
+    cout << "   Measurements: " << measurements << endl;
+    cout << rangeformat ("{ ", "; ", " }", 2) << "   First two: " << measurements << endl << rangeformat ();
+
+
+    cout << "\nIntegers in other bases and columns:\n";
+
+    uint8_t packet [] = { 0x7E, 0x01, 0xA5, 0x00, 0x3C };
+    cout << "   Packet:";
+    for (uint8_t b : packet)
+        cout << ' ' << hex << uppercase << setfill ('0') << setw (2) << b;
+    cout << dec << nouppercase << setfill (' ') << endl;
+    cout << "   Register: " << showbase << hex << 0x40021000ul << ", flags: " << bin << 0x2Du << noshowbase << dec << endl;
+    cout << "   " << left << setw (10) << "Sensor" << right << setw (6) << 1234 << endl;
 }
 
 void loop () {
@@ -0,0 +1,29 @@
+#include <locale.hpp>
+#include <sstream.hpp>
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    setlocale (lc_all, "en_150.UTF-8");
+
+    // format into your own char array, all the manipulators and locale settings work the same way as with cout
+    char message [32];
+    ostringstream os (message, sizeof (message));
+    os << "{\"temperature\":" << fixed << setprecision (1) << 23.456 << "}";
+    cout << message << endl;
+
+    // or let fixed_ostringstream have its own char array
+    fixed_ostringstream<16> small;
+    small << showpoint << 1234567890 << " is too long";
+    cout << small.c_str () << (small.truncated () ? " (truncated)" : "") << endl;
+
+    // reuse it without any memory allocation
+    small.reset ();
+    small << millis () << " ms";
+    cout << small.c_str () << endl;
+}
+
+void loop () {
+
+}
@@ -0,0 +1,27 @@
+#include <osyncstream.hpp> // ESP32 and other multi-core or RTOS boards
+
+
+// each task writes through its own osyncstream, so its lines never interleave with the lines of other tasks and its manipulators don't affect the others
+void task (void *parameter) {
+    int id = (int) parameter;
+    osyncstream out;
+    out << fixed << setprecision (id);
+
+    while (true) {
+        out << "Task " << id << " on core " << xPortGetCoreID () << ": " << millis () / 1000.0 << " s" << endl;
+        delay (100);
+    }
+}
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    xTaskCreatePinnedToCore (task, "task1", 4096, (void *) 1, 1, NULL, 0);
+    xTaskCreatePinnedToCore (task, "task2", 4096, (void *) 2, 1, NULL, 1);
+    xTaskCreatePinnedToCore (task, "task3", 4096, (void *) 3, 1, NULL, 1);
+}
+
+void loop () {
+
+}
@@ -0,0 +1,34 @@
+#include <iostream.hpp>
+
+
+// any class with write (const uint8_t *, size_t) member function can be an output device, like Serial1, WiFiClient, File, ...
+// this one counts how many times ostream actually writes to Serial
+class countingSerial {
+    public:
+        unsigned long writes = 0;
+
+        size_t write (const uint8_t *buf, size_t len) {
+            writes ++;
+            return Serial.write (buf, len);
+        }
+};
+
+countingSerial device;
+basic_ostream<countingSerial> out (device);
+
+// basic_istream<decltype (Serial1)> in (Serial1); // reads from Serial1 the same way cin reads from Serial
+
+
+void setup () {
+    cinit (); // three optional arguments: bool waitForSerial = false, unsigned int waitAfterSerial = 100 [ms], unsigned int serialSpeed = 115200 (9600 for AVR boards)
+
+    out << fixed << setprecision (2) << showpoint;
+    for (int i = 1; i <= 5; i++)
+        out << "Line " << i << ": " << 1000 * i << " + " << 0.25 * i << " = " << 1000 * i + 0.25 * i << endl;
+
+    cout << "5 lines needed " << device.writes << " writes to Serial." << endl;
+}
+
+void loop () {
+
+}
@@ -14,7 +14,19 @@
 
     // ----- TUNNING PARAMETERS -----
 
-    #define __CONSOLE_BUFFER_SIZE__ 64 // max 63 characters in internal buffer
+    #ifndef __ISTREAM_TOKEN_SIZE__
+        #define __ISTREAM_TOKEN_SIZE__ 64 // default size of the token buffer of basic_istream (max 63 characters), each instance can have its own: basic_istream<decltype (Serial1), 128> in (Serial1);
+    #endif
+
+    #ifndef __ISTREAM_RX_BUFFER_SIZE__
+        #ifdef ARDUINO_ARCH_AVR
+            #define __ISTREAM_RX_BUFFER_SIZE__ 32  // everything available in Serial is read into this buffer at once
+        #else
+            #define __ISTREAM_RX_BUFFER_SIZE__ 128 // everything available in Serial is read into this buffer at once
+        #endif
+    #endif
+
+    // #define __STREAM_STATISTICS__            // define it before including the library to count bytes, device calls, parsed values, time spent waiting for input, ... of each stream
 
 
     // ----- CODE -----
@@ -44,171 +56,738 @@
     #endif
 
 
+    // numeric facet: a snapshot of lc_numeric settings that setlocale publishes, so formatting and parsing read them directly instead of calling virtual functions for each character
+    #ifndef __NUMERIC_FACET__
+        #define __NUMERIC_FACET__
+
+        struct numericFacet {
+            char decimalSeparator;
+            char thousandsSeparator;
+            uint8_t grouping;       // the number of digits in a group, 0 for no grouping
+            char positiveSign;
+            char negativeSign;
+        };
+
+        #ifdef ARDUINO_ARCH_AVR
+            extern numericFacet lc_numeric_facet;
+            numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #else
+            inline numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #endif
+    #endif
+
+    // results of non-blocking try_read
+    enum istreamStatus {
+        wouldBlock, // the value is not complete yet, call try_read again later, what has been typed so far is kept
+        ready,      // the value has been read
+        parseError  // the input could not be converted to the value
+    };
+
+    // stream state flags, set by >> and try_read when reading fails
+    enum iostate {
+        goodbit = 0,
+        eofbit  = 1,
+        failbit = 2, // malformed input or value out of range
+        badbit  = 4
+    };
+
+    // cin >> bounded (buf, sizeof (buf)) reads a token into buf, but never more than sizeof (buf) - 1 characters
+    struct __bounded__ {
+        char *buffer;
+        size_t size;
+    };
+
+    inline __bounded__ bounded (char *buffer, size_t size) { return __bounded__ { buffer, size }; }
+
+    template<size_t N>
+    inline __bounded__ bounded (char (&buffer) [N]) { return __bounded__ { buffer, N }; }
+
+    // cin >> token gives the next token without copying it to the caller, data points into the stream's internal buffers and is valid only until the next read from the stream,
+    // it is not 0 terminated
+    struct tokenView {
+        const char *data;
+        size_t length;
+    };
+
+    // progress and result of read_array and try_read_array
+    struct arrayReadResult {
+        size_t elements = 0;    // elements read so far
+        size_t count = 0;       // elements parsed successfully
+        long firstError = -1;   // index of the first element that couldn't be parsed, -1 if there were no errors
+    };
+
+    // stream statistics, compiled in only if __STREAM_STATISTICS__ is defined before including the library
+    #ifndef __STREAM_STAT__
+        #ifdef __STREAM_STATISTICS__
+            #define __STREAM_STAT__(x) x
+        #else
+            #define __STREAM_STAT__(x)
+        #endif
+    #endif
+
+    #ifdef __STREAM_STATISTICS__
+        struct istreamStatistics {
+            unsigned long bytesRead;        // bytes read from the input device
+            unsigned long readCalls;        // reads from the input device
+            unsigned long waitMicros;       // time spent waiting for input
+            unsigned long values;           // successfully parsed values
+            unsigned long parseErrors;
+        };
+    #endif
+
     class istream {
 
       private:
 
-          char buf [__CONSOLE_BUFFER_SIZE__];
+          int __length__ = 0; // the number of characters of the current token (or line) collected so far
+          bool __truncated__ = false; // the current token (or line) doesn't fit into its buffer, the rest of it is being skipped
+          char __rx__ [__ISTREAM_RX_BUFFER_SIZE__]; // received but not yet processed characters are between __rxStart__ and __rxEnd__
+          int __rxStart__ = 0;
+          int __rxEnd__ = 0;
+          void (*__tie__) () = NULL; // called before waiting for input, so the prompt gets flushed first
+          uint8_t __state__ = goodbit;
+
+          #ifdef __STREAM_STATISTICS__
+              istreamStatistics __statistics__ = {};
+          #endif
+
+          // state of the streaming integer parser, kept between try_read calls
+          enum __integerParserState__ {
+              __skipping__,     // skipping leading white spaces
+              __sign__,         // after + or -
+              __leadingZero__,  // after leading 0, 0x or 0b prefix may follow
+              __prefix__,       // after 0x or 0b, at least one digit must follow
+              __digits__,
+              __malformed__     // skipping the rest of invalid token
+          };
+          uint8_t __intState__ = __skipping__;
+          bool __negative__ = false;
+          bool __overflow__ = false;
+          uint8_t __base__ = 10;
+          unsigned long long __accumulator__ = 0;
+
+          // state of the streaming decimal number parser used by read_array, it shares __negative__ and __accumulator__ (significant digits) with the integer parser
+          enum __decimalParserState__ {
+              __fpSkipping__,           // skipping leading white spaces
+              __fpSign__,               // after + or -
+              __fpInteger__,            // digits before the decimal separator
+              __fpFraction__,           // digits after the decimal separator
+              __fpExponent__,           // after e, the exponent sign or digits follow
+              __fpExponentSign__,       // after e+ or e-, at least one digit must follow
+              __fpExponentDigits__,
+              __fpMalformed__           // skipping the rest of invalid token
+          };
+          uint8_t __fpState__ = __fpSkipping__;
+          bool __fpDigits__ = false;    // at least one digit of the significand has been read
+          bool __fpInexact__ = false;   // more significant digits than __accumulator__ can hold
+          int __fpScale__ = 0;          // the value is __accumulator__ * 10 ^ (__fpScale__ + exponent)
+          int __fpExponentValue__ = 0;  // what follows e
+          bool __fpExponentNegative__ = false;
+
+          bool __list__ = false;        // read_array is reading, comma and semicolon separate the values too (unless they are the decimal separator)
+
+      protected:
+
+          char *__token__; // provided by the derived class, tokens that are converted to values are collected here
+          size_t __tokenSize__;
+
+          // the only device dependent part of istream, called once per fill
+          virtual int __available__ () = 0;
+          virtual int __readBytes__ (char *buf, int len) = 0;
 
       public:
 
+        istream (char *tokenBuffer, size_t tokenBufferSize) : __token__ (tokenBuffer), __tokenSize__ (tokenBufferSize) {}
+
+        // a copy would collect tokens into the buffer of the original, which lives inside the original (basic_istream)
+        istream (const istream&) = delete;
+        istream& operator = (const istream&) = delete;
+
+        // stream state
+        inline uint8_t rdstate () const { return __state__; }
+        inline bool good () const { return __state__ == goodbit; }
+        inline bool eof () const { return __state__ & eofbit; }
+        inline bool fail () const { return __state__ & (failbit | badbit); }
+        inline bool bad () const { return __state__ & badbit; }
+        inline void clear (uint8_t state = goodbit) { __state__ = state; }
+        inline void setstate (uint8_t state) { __state__ |= state; }
+        inline explicit operator bool () const { return !fail (); }
+
+        #ifdef __STREAM_STATISTICS__
+            inline istreamStatistics statistics () const { return __statistics__; }
+            inline void resetStatistics () { __statistics__ = {}; }
+        #endif
+
+        // sets the function that flushes the output before istream starts waiting for input (cout is tied automatically)
+        inline void tie (void (*flushFunction) ()) { __tie__ = flushFunction; }
+
         // istream >> char
         inline istream& operator >> (char& value) {
-            while (!Serial.available ()) 
-                delay (10);
-            value = Serial.read ();            
+            __read__ (value);
             return *this;
         }
 
         // istream >> int
         inline istream& operator >> (int& value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ())
-                    delay (10);
-                char c = Serial.read ();
-                #ifndef __LOCALE_HPP__
-                    if (c > ' ' && c <= '9' && c != '.') {
-                        buf [i] = c;
-                        buf [++ i] = 0;
-                    } else {
-                        value = atoi (buf);
-                        break;
-                    }
-                #else
-                    if (c > ' ' && c <= '9' && c != lc_numeric_locale->getDecimalSeparator ()) {
-                        buf [i] = c;
-                        buf [++ i] = 0;
-                    } else {
-                        __unLocalizeSeparators__ (buf);
-                        value = atoi (buf);
-                        break;
-                    }                
-                #endif
-            }
+            __read__ (value);
             return *this;
         } 
 
         // istream >> long
         inline istream& operator >> (long& value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ())
-                    delay (10);
-                char c = Serial.read ();
-                #ifndef __LOCALE_HPP__
-                    if (c > ' ' && c <= '9' && c != '.') {
-                        buf [i] = c;
-                        buf [++ i] = 0;
-                    } else {
-                        value = atol (buf);
-                        break;
-                    }
-                #else
-                    if (c > ' ' && c <= '9' && c != lc_numeric_locale->getDecimalSeparator ()) {
-                        buf [i] = c;
-                        buf [++ i] = 0;
-                    } else {
-                        __unLocalizeSeparators__ (buf);
-                        value = atol (buf);
-                        break;
-                    }                
-                #endif
-            }
+            __read__ (value);
             return *this;
         } 
 
         // istream >> float
         istream& operator >> (float& value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ()) 
-                    delay (10);
-                char c = Serial.read ();
-                if (c > ' ') {
-                    buf [i] = c;
-                    buf [++ i] = 0;
-                } else {
-                    __unLocalizeSeparators__ (buf);
-                    value = atof (buf);
-                    break;
-                }
-            }
+            __read__ (value);
             return *this;
         } 
 
         // istream >> double
         inline istream& operator >> (double& value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ()) 
-                    delay (10);
-                char c = Serial.read ();
-                if (c > ' ') {
-                    buf [i] = c;
-                    buf [++ i] = 0;
-                } else {
-                    __unLocalizeSeparators__ (buf);
-                    value = atof (buf);
-                    break;
-                }
-            }
+            __read__ (value);
             return *this;
         } 
 
-        // istream >> char * // warning, it doesn't chech buffer overflow
+        // istream >> other integer types (short, unsigned, long long, ...) goes through the same streaming integer parser, decimal, 0x hexadecimal or 0b binary
+
+        // istream >> char * // warning, it only checks that the token fits into the token buffer of the stream, use bounded (value, size) to check the size of value
         inline istream& operator >> (char *value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ()) 
-                    delay (10);
-                char c = Serial.read ();
-                if (c > ' ') {
-                    buf [i] = c;
-                    buf [++ i] = 0;
-                } else {
-                    strcpy (value, buf);
-                    break;
-                }
-            }
+            __read__ (value);
+            return *this;
+        }
+
+        // istream >> bounded (buf, size), tokens that don't fit are truncated, the rest of the token is skipped and failbit is set
+        inline istream& operator >> (const __bounded__& value) {
+            __read__ (value);
+            return *this;
+        }
+
+        // istream >> tokenView, without copying when the whole token is already received
+        inline istream& operator >> (tokenView& value) {
+            __read__ (value);
             return *this;
         }
 
         // istream >> any other class that has a constructor of type T (char *)
         template<typename T>
         inline istream& operator >> (T& value) {
-            buf [0] = 0;
-            int i = 0;
-            while (i < __CONSOLE_BUFFER_SIZE__ - 1) {
-                while (!Serial.available ()) 
-                    delay (10);
-                char c = Serial.read ();
-                if (c > ' ') {
-                    buf [i] = c;
-                    buf [++ i] = 0;
-                } else {
-                    value = T (buf);
-                    break;
+            __read__ (value);
+            return *this;
+        }
+
+
+        // reads the line into buf without the delimiter (and \r before \n), lines longer than size - 1 characters are truncated, the rest of the line is skipped and failbit is set
+        inline istream& getline (char *buf, size_t size, char delimiter = '\n') {
+            if (__tie__)
+                __tie__ ();
+            while (try_getline (buf, size, delimiter) == wouldBlock)
+                __waitForInput__ ();
+            return *this;
+        }
+
+        // reads size integers or floating points separated by white spaces, commas or semicolons directly into array in one pass through the input,
+        // elements that can't be parsed don't stop reading, result tells how many were parsed and where the first error was
+        template<typename T>
+        inline arrayReadResult read_array (T *array, size_t size) {
+            arrayReadResult result;
+            if (__tie__)
+                __tie__ ();
+            while (try_read_array (array, size, result) == wouldBlock)
+                __waitForInput__ ();
+            return result;
+        }
+
+        // non-blocking reading: takes whatever is available in the input device and returns immediately, so it can be called from each loop () until the value is ready
+        inline istreamStatus try_read (char& value) {
+            if (__rxStart__ == __rxEnd__ && !__fill__ ())
+                return wouldBlock;
+            value = __rx__ [__rxStart__ ++];
+            __STREAM_STAT__ (__statistics__.values ++);
+            return ready;
+        }
+
+        inline istreamStatus try_read (char *value) { return __tryReadToken__ (value, __tokenSize__); }
+
+        // the same buffer should be passed to each call until the token is ready, since what has been received so far is kept there
+        inline istreamStatus try_read (const __bounded__& value) { return __tryReadToken__ (value.buffer, value.size); }
+
+        inline istreamStatus try_read (tokenView& value) {
+            if (!__length__ && !__truncated__) { // if the whole token is already in __rx__ it doesn't get copied at all
+                while (__rxStart__ < __rxEnd__ && __rx__ [__rxStart__] <= ' ')
+                    __rxStart__ ++;
+                int end = __rxStart__;
+                while (end < __rxEnd__ && __rx__ [end] > ' ')
+                    end ++;
+                if (end < __rxEnd__ && end > __rxStart__) {
+                    value = { __rx__ + __rxStart__, (size_t) (end - __rxStart__) };
+                    __rxStart__ = end + 1;
+                    __STREAM_STAT__ (__statistics__.values ++);
+                    return ready;
                 }
             }
-            return *this;
+            if (!__collectToken__ (__token__, __tokenSize__))
+                return wouldBlock;
+            value = { __token__, strlen (__token__) };
+            return __tokenStatus__ ();
+        }
+
+        // result keeps the progress between calls, so the same array and result should be passed to each call, returns ready when all the elements are parsed or parseError when they are all read but some couldn't be parsed
+        template<typename T>
+        inline istreamStatus try_read_array (T *array, size_t size, arrayReadResult& result) {
+            __list__ = true;
+            while (result.elements < size) {
+                istreamStatus status = __tryReadElement__ (array [result.elements]);
+                if (status == wouldBlock) {
+                    __list__ = false;
+                    return wouldBlock;
+                }
+                if (status == ready)
+                    result.count ++;
+                else if (result.firstError < 0)
+                    result.firstError = (long) result.elements;
+                result.elements ++;
+            }
+            __list__ = false;
+            return result.count == size ? ready : parseError;
+        }
+
+        // the same buffer should be passed to each call until the line is ready, since what has been received so far is kept there
+        inline istreamStatus try_getline (char *buf, size_t size, char delimiter = '\n') {
+            while (__rxStart__ < __rxEnd__ || __fill__ ()) {
+                char c = __rx__ [__rxStart__ ++];
+                if (c != delimiter) {
+                    __store__ (buf, size, c);
+                    continue;
+                }
+                if (delimiter == '\n' && __length__ && buf [__length__ - 1] == '\r')
+                    __length__ --;
+                if (size)
+                    buf [__length__] = 0;
+                __length__ = 0;
+                return __tokenStatus__ ();
+            }
+            return wouldBlock;
+        }
+
+        inline istreamStatus try_read (short& value) { return __tryReadInteger__<short, unsigned short> (value, true); }
+        inline istreamStatus try_read (unsigned short& value) { return __tryReadInteger__<unsigned short, unsigned short> (value, false); }
+        inline istreamStatus try_read (int& value) { return __tryReadInteger__<int, unsigned int> (value, true); }
+        inline istreamStatus try_read (unsigned int& value) { return __tryReadInteger__<unsigned int, unsigned int> (value, false); }
+        inline istreamStatus try_read (long& value) { return __tryReadInteger__<long, unsigned long> (value, true); }
+        inline istreamStatus try_read (unsigned long& value) { return __tryReadInteger__<unsigned long, unsigned long> (value, false); }
+        inline istreamStatus try_read (long long& value) { return __tryReadInteger__<long long, unsigned long long> (value, true); }
+        inline istreamStatus try_read (unsigned long long& value) { return __tryReadInteger__<unsigned long long, unsigned long long> (value, false); }
+
+        template<typename T>
+        inline istreamStatus try_read (T& value) {
+            if (!__collectToken__ (__token__, __tokenSize__))
+                return wouldBlock;
+            if (!__truncated__ && __convert__ (value)) {
+                __STREAM_STAT__ (__statistics__.values ++);
+                return ready;
+            }
+            __truncated__ = false;
+            __state__ |= failbit;
+            __STREAM_STAT__ (__statistics__.parseErrors ++);
+            return parseError;
         }
 
         private:
 
+            // blocking reading is just non-blocking reading that waits for the input
+            template<typename T>
+            inline void __read__ (T& value) {
+                if (__tie__)
+                    __tie__ ();
+                while (try_read (value) == wouldBlock) 
+                    __waitForInput__ ();
+            }
+
+            inline void __read__ (char *value) {
+                if (__tie__)
+                    __tie__ ();
+                while (try_read (value) == wouldBlock) 
+                    __waitForInput__ ();
+            }
+
+            inline void __read__ (const __bounded__& value) {
+                if (__tie__)
+                    __tie__ ();
+                while (try_read (value) == wouldBlock) 
+                    __waitForInput__ ();
+            }
+
+            // returns as soon as something arrives, instead of sleeping for a fixed time
+            inline void __waitForInput__ () {
+                __STREAM_STAT__ (unsigned long start = micros ());
+                while (__available__ () <= 0)
+                    #ifdef ARDUINO_ARCH_ESP32
+                        delay (1); // let FreeRTOS run lower priority tasks
+                    #else
+                        yield ();
+                    #endif
+                __STREAM_STAT__ (__statistics__.waitMicros += micros () - start);
+            }
+
+            // reads everything available in the input device into __rx__ in one piece, returns true if anything has been read
+            inline bool __fill__ () {
+                int available = __available__ ();
+                if (available <= 0)
+                    return false;
+                int pending = __rxEnd__ - __rxStart__;
+                if (pending <= 0) {
+                    __rxStart__ = __rxEnd__ = 0;
+                } else if (__rxStart__ && __rxEnd__ + available > __ISTREAM_RX_BUFFER_SIZE__) { // make room at the end, unprocessed characters stay contiguous
+                    memmove (__rx__, __rx__ + __rxStart__, pending);
+                    __rxStart__ = 0;
+                    __rxEnd__ = pending;
+                }
+                if (available > __ISTREAM_RX_BUFFER_SIZE__ - __rxEnd__)
+                    available = __ISTREAM_RX_BUFFER_SIZE__ - __rxEnd__;
+                int read = __readBytes__ (__rx__ + __rxEnd__, available);
+                __STREAM_STAT__ (__statistics__.readCalls ++; __statistics__.bytesRead += read);
+                __rxEnd__ += read;
+                return __rxStart__ < __rxEnd__;
+            }
+
+            // incremental tokenizer: skips leading white spaces, then collects token characters into token (of size bytes) until the token ends, returns true when the token is complete (and resets its state for the next one),
+            // __truncated__ tells if the token didn't fit
+            inline bool __collectToken__ (char *token, size_t size) {
+                while (__rxStart__ < __rxEnd__ || __fill__ ()) {
+                    char c = __rx__ [__rxStart__ ++];
+                    if (c > ' ') {
+                        __store__ (token, size, c);
+                        continue;
+                    }
+                    if (!__length__ && !__truncated__)
+                        continue; // skip leading white spaces
+                    if (size)
+                        token [__length__] = 0;
+                    __length__ = 0;
+                    return true;
+                }
+                return false;
+            }
+
+            // appends c to the token or line being collected if there is still room for it and the terminating 0
+            inline void __store__ (char *buf, size_t size, char c) {
+                if ((size_t) __length__ + 1 < size)
+                    buf [__length__ ++] = c;
+                else
+                    __truncated__ = true;
+            }
+
+            inline istreamStatus __tryReadToken__ (char *buf, size_t size) {
+                if (!__collectToken__ (buf, size))
+                    return wouldBlock;
+                return __tokenStatus__ ();
+            }
+
+            // the status of the token or line that has just been collected
+            inline istreamStatus __tokenStatus__ () {
+                if (__truncated__) {
+                    __truncated__ = false;
+                    __state__ |= failbit;
+                    __STREAM_STAT__ (__statistics__.parseErrors ++);
+                    return parseError;
+                }
+                __STREAM_STAT__ (__statistics__.values ++);
+                return ready;
+            }
+
+            // streaming integer parser: accumulates the value while scanning the received characters, skips thousands separators, detects overflow and malformed input
+            template<typename T, typename U>
+            inline istreamStatus __tryReadInteger__ (T& value, bool isSigned) {
+                numericFacet facet = lc_numeric_facet;
+                U acc = (U) __accumulator__;
+                U max = isSigned ? ((U) ~(U) 0) >> 1 : (U) ~(U) 0;
+                U cutoff = 0;
+                uint8_t cutlim = 0;
+                bool cutoffKnown = false;
+
+                while (__rxStart__ < __rxEnd__ || __fill__ ()) {
+                    #ifndef ARDUINO_ARCH_AVR
+                        // convert 8 digits at once when they are already in the buffer (SWAR), this pays off only on 32 bit boards
+                        if (sizeof (U) >= 4 && __intState__ == __digits__ && __base__ == 10 && !__overflow__) {
+                            U swarCutoff = (max + (__negative__ ? 1 : 0) - 99999999) / 100000000;
+                            uint32_t eightDigits;
+                            while (__rxEnd__ - __rxStart__ >= 8 && acc <= swarCutoff && __eightDigits__ (__rx__ + __rxStart__, eightDigits)) {
+                                acc = acc * 100000000 + eightDigits;
+                                __rxStart__ += 8;
+                            }
+                            if (__rxStart__ == __rxEnd__)
+                                continue;
+                        }
+                    #endif
+
+                    char c = __rx__ [__rxStart__ ++];
+
+                    if (c <= ' ' || (__list__ && __listSeparator__ (c, facet))) { // white space
+                        if (__intState__ == __skipping__)
+                            continue;
+                        // end of token
+                        istreamStatus status = ready;
+                        if (__intState__ == __malformed__ || __intState__ == __sign__ || __intState__ == __prefix__) {
+                            value = 0;
+                            status = parseError;
+                        } else if (__overflow__) {
+                            value = __negative__ ? (T) (max + 1) : (T) max;
+                            status = parseError;
+                        } else {
+                            value = __negative__ ? (T) (0 - acc) : (T) acc;
+                        }
+                        if (status == parseError) {
+                            __state__ |= failbit;
+                            __STREAM_STAT__ (__statistics__.parseErrors ++);
+                        } else {
+                            __STREAM_STAT__ (__statistics__.values ++);
+                        }
+                        __intState__ = __skipping__;
+                        __negative__ = __overflow__ = false;
+                        __base__ = 10;
+                        __accumulator__ = 0;
+                        return status;
+                    }
+
+                    switch (__intState__) {
+                        case __malformed__:
+                                            continue;
+                        case __skipping__:
+                                            __intState__ = __sign__;
+                                            if (c == facet.positiveSign || (c == facet.negativeSign && isSigned)) {
+                                                __negative__ = c == facet.negativeSign;
+                                                continue;
+                                            }
+                                            // fall through - c may be the first digit
+                        case __sign__:
+                                            if (c == '0') {
+                                                __intState__ = __leadingZero__;
+                                                continue;
+                                            }
+                                            break;
+                        case __leadingZero__:
+                                            if (c == 'x' || c == 'X' || c == 'b' || c == 'B') {
+                                                __base__ = (c == 'x' || c == 'X') ? 16 : 2;
+                                                __intState__ = __prefix__;
+                                                continue;
+                                            }
+                                            break;
+                        default:
+                                            if (c == facet.thousandsSeparator && __base__ == 10 && __intState__ == __digits__)
+                                                continue;
+                                            break;
+                    }
+
+                    // c should be a digit
+                    uint8_t d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 255;
+                    if (d >= __base__) {
+                        __intState__ = __malformed__;
+                        continue;
+                    }
+                    __intState__ = __digits__;
+                    if (!cutoffKnown) {
+                        U limit = max + (__negative__ ? 1 : 0);
+                        cutoff = limit / __base__;
+                        cutlim = limit % __base__;
+                        cutoffKnown = true;
+                    }
+                    if (acc > cutoff || (acc == cutoff && d > cutlim))
+                        __overflow__ = true;
+                    else
+                        acc = acc * __base__ + d;
+                }
+                __accumulator__ = acc;
+                return wouldBlock;
+            }
+
+            inline bool __listSeparator__ (char c, const numericFacet& facet) const { return (c == ',' || c == ';') && c != facet.decimalSeparator; }
+
+            // elements of read_array
+            template<typename T>
+            inline istreamStatus __tryReadElement__ (T& value) { return try_read (value); } // integers
+
+            inline istreamStatus __tryReadElement__ (float& value) {
+                double d;
+                istreamStatus status = __tryReadDecimal__ (d);
+                value = (float) d;
+                return status;
+            }
+
+            inline istreamStatus __tryReadElement__ (double& value) { return __tryReadDecimal__ (value); }
+
+            // streaming decimal number parser: collects up to 19 significant digits and the decimal exponent while scanning the received characters, the value is calculated exactly when it can be
+            // (no more than 15 digits and 10 ^ |exponent| <= 10 ^ 22, 7 digits and 10 ^ 10 with 4 byte doubles), otherwise the token, which is also collected in __token__, is converted by strtod
+            inline istreamStatus __tryReadDecimal__ (double& value) {
+                numericFacet facet = lc_numeric_facet;
+                while (__rxStart__ < __rxEnd__ || __fill__ ()) {
+                    char c = __rx__ [__rxStart__ ++];
+
+                    if (c <= ' ' || (__list__ && __listSeparator__ (c, facet))) {
+                        if (__fpState__ == __fpSkipping__)
+                            continue;
+                        // end of token
+                        bool valid = __fpDigits__ && (__fpState__ == __fpInteger__ || __fpState__ == __fpFraction__ || __fpState__ == __fpExponentDigits__);
+                        if (valid)
+                            valid = __decimalValue__ (value);
+                        else
+                            value = 0;
+                        __fpState__ = __fpSkipping__;
+                        __fpDigits__ = __fpInexact__ = __fpExponentNegative__ = __negative__ = __truncated__ = false;
+                        __fpScale__ = __fpExponentValue__ = 0;
+                        __accumulator__ = 0;
+                        __length__ = 0;
+                        if (!valid) {
+                            __state__ |= failbit;
+                            __STREAM_STAT__ (__statistics__.parseErrors ++);
+                            return parseError;
+                        }
+                        __STREAM_STAT__ (__statistics__.values ++);
+                        return ready;
+                    }
+
+                    uint8_t d = c - '0';
+                    switch (__fpState__) {
+                        case __fpSkipping__:
+                                            __fpState__ = __fpSign__;
+                                            if (c == facet.positiveSign || c == facet.negativeSign) {
+                                                __negative__ = c == facet.negativeSign;
+                                                if (__negative__)
+                                                    __store__ (__token__, __tokenSize__, '-');
+                                                continue;
+                                            }
+                                            // fall through - c may be the first digit
+                        case __fpSign__:
+                        case __fpInteger__:
+                                            if (d <= 9) {
+                                                __fpState__ = __fpInteger__;
+                                                __significantDigit__ (d, false);
+                                                __store__ (__token__, __tokenSize__, c);
+                                                continue;
+                                            }
+                                            if (c == facet.decimalSeparator) {
+                                                __fpState__ = __fpFraction__;
+                                                __store__ (__token__, __tokenSize__, '.');
+                                                continue;
+                                            }
+                                            if (c == facet.thousandsSeparator && __fpState__ == __fpInteger__)
+                                                continue;
+                                            // fall through - e may follow the digits
+                        case __fpFraction__:
+                                            if (d <= 9 && __fpState__ == __fpFraction__) {
+                                                __significantDigit__ (d, true);
+                                                __store__ (__token__, __tokenSize__, c);
+                                                continue;
+                                            }
+                                            if ((c == 'e' || c == 'E') && __fpDigits__) {
+                                                __fpState__ = __fpExponent__;
+                                                __store__ (__token__, __tokenSize__, 'e');
+                                                continue;
+                                            }
+                                            break;
+                        case __fpExponent__:
+                                            if (c == '+' || c == '-') {
+                                                __fpExponentNegative__ = c == '-';
+                                                __fpState__ = __fpExponentSign__;
+                                                __store__ (__token__, __tokenSize__, c);
+                                                continue;
+                                            }
+                                            // fall through - c may be the first digit of the exponent
+                        case __fpExponentSign__:
+                        case __fpExponentDigits__:
+                                            if (d <= 9) {
+                                                __fpState__ = __fpExponentDigits__;
+                                                if (__fpExponentValue__ < 10000) // the value is 0 or inf long before that
+                                                    __fpExponentValue__ = __fpExponentValue__ * 10 + d;
+                                                __store__ (__token__, __tokenSize__, c);
+                                                continue;
+                                            }
+                                            break;
+                        default:            // __fpMalformed__
+                                            continue;
+                    }
+                    __fpState__ = __fpMalformed__;
+                }
+                return wouldBlock;
+            }
+
+            inline void __significantDigit__ (uint8_t d, bool fraction) {
+                __fpDigits__ = true;
+                if (__accumulator__ < 1000000000000000000ull) { // 19 digits fit into 64 bits
+                    __accumulator__ = __accumulator__ * 10 + d;
+                    if (fraction)
+                        __fpScale__ --;
+                } else {
+                    __fpInexact__ |= d != 0;
+                    if (!fraction)
+                        __fpScale__ ++;
+                }
+            }
+
+            // calculates the value of the parsed decimal number, returns false if it can't be done
+            inline bool __decimalValue__ (double& value) {
+                int exponent = __fpScale__ + (__fpExponentNegative__ ? -__fpExponentValue__ : __fpExponentValue__);
+                bool smallDouble = sizeof (double) == 4; // AVR boards
+                unsigned long long maxExact = smallDouble ? 1ull << 24 : 1ull << 53;
+                int maxExponent = smallDouble ? 10 : 22;
+                if (!__fpInexact__ && __accumulator__ <= maxExact && exponent >= -maxExponent && exponent <= maxExponent) {
+                    // both the significand and the power of 10 are exact, so a single multiplication or division rounds correctly
+                    double p = 1;
+                    for (int i = exponent < 0 ? -exponent : exponent; i; i--)
+                        p *= 10;
+                    value = exponent < 0 ? (double) __accumulator__ / p : (double) __accumulator__ * p;
+                    if (__negative__)
+                        value = -value;
+                    return true;
+                }
+                if (__truncated__) // the token is longer than the token buffer
+                    return false;
+                __token__ [__length__] = 0;
+                value = strtod (__token__, NULL);
+                return value - value == 0; // inf means out of range
+            }
+
+            #ifndef ARDUINO_ARCH_AVR
+                // if all 8 characters are decimal digits converts them to a number at once
+                static inline bool __eightDigits__ (const char *p, uint32_t& value) {
+                    uint64_t v;
+                    memcpy (&v, p, 8); // little endian
+                    if ((v & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull || ((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull)
+                        return false;
+                    v -= 0x3030303030303030ull;
+                    v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFull;
+                    v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFull;
+                    value = (uint32_t) (v * 10000 + (v >> 32));
+                    return true;
+                }
+            #endif
+
+            // converters from the collected token to the value, return false if the token is not valid
+            inline bool __convert__ (float& value) {
+                __unLocalizeSeparators__ (__token__);
+                char *end;
+                value = (float) strtod (__token__, &end);
+                return *__token__ && !*end;
+            }
+
+            inline bool __convert__ (double& value) {
+                __unLocalizeSeparators__ (__token__);
+                char *end;
+                value = strtod (__token__, &end);
+                return *__token__ && !*end;
+            }
+
+            template<typename T>
+            inline bool __convert__ (T& value) {
+                value = T (__token__);
+                return true;
+            }
+
             inline void __unLocalizeSeparators__ (char *buf) {
-                #ifdef __LOCALE_HPP__
-                    char thousandsSeparator = lc_numeric_locale->getThousandsSeparator ();
-                    char decimalSeparator = lc_numeric_locale->getDecimalSeparator ();
-                #else
-                    char thousandsSeparator = ',';
-                    char decimalSeparator = '.';
-                #endif
+                char thousandsSeparator = lc_numeric_facet.thousandsSeparator;
+                char decimalSeparator = lc_numeric_facet.decimalSeparator;
 
                 int i = 0; 
                 for (int j = 0; buf [j]; j++)
@@ -221,12 +800,44 @@
 
     };
 
+    // istream that reads from any device with Stream-like available () and readBytes (char *, size_t) member functions (Serial1, WiFiClient, File, ...), for example: basic_istream<WiFiClient> clientIn (client);
+    // tokenSize is the size of the buffer that tokens are collected in before they are converted to values
+    template<typename Device, size_t tokenSize = __ISTREAM_TOKEN_SIZE__>
+    class basic_istream : public istream {
+
+        public:
+
+            basic_istream (Device& device) : istream (__storage__, tokenSize), __device__ (device) {}
+
+        private:
+
+            Device& __device__;
+            char __storage__ [tokenSize];
+
+            int __available__ () override { return __device__.available (); }
+            int __readBytes__ (char *buf, int len) override { return __device__.readBytes (buf, len); }
+    };
+
     // Create a working instnces
     #ifdef ARDUINO_ARCH_AVR
-        extern istream cin;
-        istream cin;
+        extern basic_istream<decltype (Serial)> cin;
+        basic_istream<decltype (Serial)> cin (Serial);
     #else
-        inline istream cin;
+        inline basic_istream<decltype (Serial)> cin (Serial);
+    #endif
+
+    // flush cout before cin starts waiting for input
+    #if defined (__OSTREAM_HPP__) && !defined (__CIN_TIE__)
+        #define __CIN_TIE__
+
+        inline void __flushCout__ () { cout.flush (); }
+
+        #ifdef ARDUINO_ARCH_AVR
+            extern bool __cin_tie__;
+            bool __cin_tie__ = (cin.tie (__flushCout__), true);
+        #else
+            inline bool __cin_tie__ = (cin.tie (__flushCout__), true);
+        #endif
     #endif
 
 #endif
@@ -11,6 +11,85 @@
 #ifndef __LOCALE_HPP__
     #define __LOCALE_HPP__
 
+
+    // ----- TUNNING PARAMETERS -----
+
+    #ifndef __LOCALE_REGISTRY_SIZE__
+        #ifdef ARDUINO_ARCH_AVR
+            #define __LOCALE_REGISTRY_SIZE__ 4  // the maximum number of locales, including the default one, must be a power of 2
+        #else
+            #define __LOCALE_REGISTRY_SIZE__ 16 // the maximum number of locales, including the default one, must be a power of 2
+        #endif
+    #endif
+
+
+    // ----- CODE -----
+
+    // decodes a valid UTF-8 character at p into its code point and moves p to the next character, invalid sequences (unexpected continuation bytes, overlong encodings,
+    // surrogates, code points above U+10FFFF or truncated sequences) decode into U+FFFD and p moves past the maximal invalid subpart, which is at least one byte but never past the terminating 0
+    inline uint32_t __utf8Decode__ (const char *&p) {
+        unsigned char lead = (unsigned char) *p ++;
+        if (lead < 0x80)
+            return lead;
+
+        uint32_t codepoint;
+        int continuations;
+        unsigned char low = 0x80, high = 0xBF; // valid range of the first continuation byte
+        if (lead < 0xC2) {
+            return 0xFFFD; // continuation byte or overlong 2 byte sequence
+        } else if (lead < 0xE0) {
+            codepoint = lead & 0x1F;
+            continuations = 1;
+        } else if (lead < 0xF0) {
+            codepoint = lead & 0x0F;
+            continuations = 2;
+            if (lead == 0xE0) low = 0xA0;       // overlong
+            else if (lead == 0xED) high = 0x9F; // surrogates
+        } else if (lead < 0xF5) {
+            codepoint = lead & 0x07;
+            continuations = 3;
+            if (lead == 0xF0) low = 0x90;       // overlong
+            else if (lead == 0xF4) high = 0x8F; // above U+10FFFF
+        } else {
+            return 0xFFFD;
+        }
+
+        while (continuations --) {
+            unsigned char c = (unsigned char) *p;
+            if (c < low || c > high)
+                return 0xFFFD;
+            codepoint = (codepoint << 6) | (c & 0x3F);
+            p ++;
+            low = 0x80;
+            high = 0xBF;
+        }
+        return codepoint;
+    }
+
+    // ASCII fast path: returns the number of leading pure ASCII bytes (without 0) of s, at most max, the caller guarantees that max bytes of s can be read
+    // (its length is known), so words are only loaded from inside the string
+    inline size_t __asciiRun__ (const char *s, size_t max) {
+        const char *p = s;
+        #ifndef ARDUINO_ARCH_AVR
+            const size_t ones = (size_t) -1 / 0xFF;     // 0x0101...01
+            const size_t highs = ones * 0x80;           // 0x8080...80
+            while ((uintptr_t) p % sizeof (size_t) && (size_t) (p - s) < max && *p && !(*p & 0x80))
+                p ++;
+            // p is aligned here unless the loop above stopped early: at a 0 or non-ASCII byte, whose word ends the loop below at once, or at max, where it doesn't start,
+            // memcpy keeps the load valid in any case and compiles into a single load without breaking aliasing rules
+            while ((size_t) (p - s) + sizeof (size_t) <= max) {
+                size_t v;
+                memcpy (&v, p, sizeof (v));
+                if ((v & highs) || ((v - ones) & ~v & highs))   // non-ASCII or 0 byte in the word
+                    break;
+                p += sizeof (size_t);
+            }
+        #endif
+        while ((size_t) (p - s) < max && *p && !(*p & 0x80))
+            p ++;
+        return p - s;
+    }
+
     struct utf8char {
         char c_str [5] = {}; // max 4 + null terminator
         public:
@@ -26,15 +105,28 @@
             return strcmp (c_str, other.c_str) == 0;
         }
 
+        // code point of the character, a named function rather than a conversion, so that cout << c and comparisons don't silently use the number
+        inline uint32_t codepoint () const {
+            const char *p = c_str;
+            return __utf8Decode__ (p);
+        }
+
+        // utf8_iterator dereferences into code points, so *it == utf8char ("Č") compares code points
+        friend inline bool operator == (uint32_t codepoint, const utf8char& c) { return codepoint == c.codepoint (); }
+        friend inline bool operator == (const utf8char& c, uint32_t codepoint) { return codepoint == c.codepoint (); }
+        friend inline bool operator != (uint32_t codepoint, const utf8char& c) { return codepoint != c.codepoint (); }
+        friend inline bool operator != (const utf8char& c, uint32_t codepoint) { return codepoint != c.codepoint (); }
+
         inline int length (unsigned char lead) {
             if ((lead & 0x80) == 0) return 1;           // 0xxxxxxx
             if ((lead & 0xE0) == 0xC0) return 2;        // 110xxxxx
             if ((lead & 0xF0) == 0xE0) return 3;        // 1110xxxx
             if ((lead & 0xF8) == 0xF0) return 4;        // 11110xxx
-            return 0; // doesn't happen
+            return 1; // invalid lead byte
         }
     };
 
+    // iterates through UTF-8 characters, dereferencing decodes the character into its code point, invalid sequences decode into U+FFFD
     class utf8_iterator {
         const char* __ptr__;
 
@@ -46,34 +138,66 @@
                 if ((lead & 0xE0) == 0xC0) return 2;        // 110xxxxx
                 if ((lead & 0xF0) == 0xE0) return 3;        // 1110xxxx
                 if ((lead & 0xF8) == 0xF0) return 4;        // 11110xxx
-                return 0; // doesn't happen
+                return 1; // invalid lead byte
             }
 
-        inline utf8char operator *() const {
-            int len = length (static_cast<unsigned char> (*__ptr__));
-            utf8char u8c;
-            memcpy (u8c.c_str, __ptr__, len);
-            u8c.c_str [len] = '\0';
-            return u8c;
+        inline uint32_t operator *() const {
+            const char *p = __ptr__;
+            return __utf8Decode__ (p);
         }
 
         inline char* get () const { return (char *) __ptr__; }
 
         inline void set (const utf8char& c) {
-            int len = length (static_cast<unsigned char> (*__ptr__));
-            memcpy ((void *) __ptr__, c.c_str, len); // overwrite in-place
+            const char *p = __ptr__;
+            __utf8Decode__ (p);
+            if (strlen (c.c_str) == (size_t) (p - __ptr__))
+                memcpy ((void *) __ptr__, c.c_str, p - __ptr__); // overwrite in-place, only if the new character occupies the same number of bytes
         }
 
         inline utf8_iterator& operator ++ () {
-            int len = length (static_cast<unsigned char> (*__ptr__));
-            __ptr__ += len;
+            __utf8Decode__ (__ptr__);
             return *this;
         }
 
+        // moves n characters forward but not past the terminating 0, skipping pure ASCII text a word at a time
+        inline utf8_iterator& advance (size_t n) {
+            // n characters take at most 4 n bytes, so only that much of the string needs to be measured
+            const char *end = __ptr__ + strnlen (__ptr__, n < (size_t) -1 / 4 ? 4 * n : (size_t) -1);
+            while (n && __ptr__ < end) {
+                size_t ascii = __asciiRun__ (__ptr__, n < (size_t) (end - __ptr__) ? n : end - __ptr__);
+                __ptr__ += ascii;
+                n -= ascii;
+                if (n && *__ptr__) {
+                    __utf8Decode__ (__ptr__);
+                    n --;
+                }
+            }
+            return *this;
+        }
+
+        inline bool operator == (const utf8_iterator& other) const { return __ptr__ == other.__ptr__; }
+        inline bool operator != (const utf8_iterator& other) const { return __ptr__ != other.__ptr__; }
         inline bool operator < (const utf8_iterator& other) const { return __ptr__ < other.__ptr__; }
         inline bool operator <= (const utf8_iterator& other) const { return __ptr__ <= other.__ptr__; }
     };
 
+    // returns the number of characters (invalid sequences count as U+FFFD characters) in s, skipping pure ASCII text a word at a time
+    inline size_t count_codepoints (const char *s) {
+        size_t count = 0;
+        const char *end = s + strlen (s);
+        while (s < end) {
+            size_t ascii = __asciiRun__ (s, end - s);
+            s += ascii;
+            count += ascii;
+            if (s < end) {
+                __utf8Decode__ (s);
+                count ++;
+            }
+        }
+        return count;
+    }
+
 
     // Please note that not all locale categories are supported
     enum localeCategory_t {
@@ -87,43 +211,200 @@
     };
 
 
+    // lc_collate weight of a character, locales supply tables of weights, sorted by code point, for characters that don't sort by their code point
+    struct collationWeight {
+        uint32_t codepoint;
+        uint32_t weight;    // only 24 bits are used, the default weight is 4 * code point which leaves room for 3 characters between each two consecutive code points
+    };
+
+
+    // lc_ctype case mapping of a range of code points: each code point from first to last (every one or every other, depending on step) maps to code point + delta
+    struct caseMapping {
+        uint16_t first;
+        uint16_t last;
+        int16_t delta;
+        uint8_t step;       // 1 or 2
+    };
+
+    // case mapping tables for Latin-1 Supplement and Latin Extended-A (ASCII letters are always mapped), that locales can reference, ß and ŉ are not mapped since their upper case forms consist of two characters, neither is µ whose upper case form is Greek
+    #ifdef ARDUINO_ARCH_AVR
+        extern const caseMapping latinToUpper [10];
+        const caseMapping latinToUpper [10] = {
+    #else
+        inline constexpr caseMapping latinToUpper [10] = {
+    #endif
+            { 0x00E0, 0x00F6, -32, 1 }, { 0x00F8, 0x00FE, -32, 1 }, { 0x00FF, 0x00FF, 121, 1 },     // à-ö, ø-þ, ÿ
+            { 0x0101, 0x012F, -1, 2 }, { 0x0131, 0x0131, -232, 1 }, { 0x0133, 0x0137, -1, 2 },      // ā-į, ı -> I, ĳ-ķ
+            { 0x013A, 0x0148, -1, 2 }, { 0x014B, 0x0177, -1, 2 }, { 0x017A, 0x017E, -1, 2 },        // ĺ-ň, ŋ-ŷ, ź-ž
+            { 0x017F, 0x017F, -300, 1 }                                                             // ſ -> S
+        };
+
+    #ifdef ARDUINO_ARCH_AVR
+        extern const caseMapping latinToLower [9];
+        const caseMapping latinToLower [9] = {
+    #else
+        inline constexpr caseMapping latinToLower [9] = {
+    #endif
+            { 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 },                                   // À-Ö, Ø-Þ
+            { 0x0100, 0x012E, 1, 2 }, { 0x0130, 0x0130, -199, 1 }, { 0x0132, 0x0136, 1, 2 },        // Ā-Į, İ -> i, Ĳ-Ķ
+            { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 }, { 0x0178, 0x0178, -121, 1 },        // Ĺ-Ň, Ŋ-Ŷ, Ÿ -> ÿ
+            { 0x0179, 0x017D, 1, 2 }                                                                // Ź-Ž
+        };
+
+    // maps code point through a case mapping table sorted by code point
+    inline uint32_t __mapCase__ (uint32_t codepoint, const caseMapping *table, size_t count) {
+        for (size_t i = 0; i < count && table [i].first <= codepoint; i++)
+            if (codepoint <= table [i].last && (codepoint - table [i].first) % table [i].step == 0)
+                return codepoint + table [i].delta;
+        return codepoint;
+    }
+
+    // encodes code point into UTF-8 and returns the number of bytes
+    inline int __utf8Encode__ (uint32_t codepoint, char *dest) {
+        if (codepoint < 0x80) { dest [0] = (char) codepoint; return 1; }
+        if (codepoint < 0x800) { dest [0] = (char) (0xC0 | (codepoint >> 6)); dest [1] = (char) (0x80 | (codepoint & 0x3F)); return 2; }
+        if (codepoint < 0x10000) { dest [0] = (char) (0xE0 | (codepoint >> 12)); dest [1] = (char) (0x80 | ((codepoint >> 6) & 0x3F)); dest [2] = (char) (0x80 | (codepoint & 0x3F)); return 3; }
+        dest [0] = (char) (0xF0 | (codepoint >> 18)); dest [1] = (char) (0x80 | ((codepoint >> 12) & 0x3F)); dest [2] = (char) (0x80 | ((codepoint >> 6) & 0x3F)); dest [3] = (char) (0x80 | (codepoint & 0x3F)); return 4;
+    }
+
+    // converts case of ps in-place: ASCII letters are converted a word at a time (a byte at a time on AVR), multi-byte characters through the table,
+    // a mapping is only applied if it doesn't make the character longer, so the string can only shrink and the writing never overtakes the reading
+    inline void __convertCase__ (char *ps, bool upper, const caseMapping *table, size_t count) {
+        char first = upper ? 'a' : 'A';
+        char last = upper ? 'z' : 'Z';
+        char *w = ps;
+        const char *r = ps;
+        #ifndef ARDUINO_ARCH_AVR
+            const char *end = ps + strlen (ps);
+        #endif
+        while (true) {
+            #ifndef ARDUINO_ARCH_AVR
+                // fast path for pure ASCII words, only whole aligned words before the terminating 0 are loaded, the tail goes through the byte loop below
+                const size_t ones = (size_t) -1 / 0xFF;     // 0x0101...01
+                const size_t highs = ones * 0x80;           // 0x8080...80
+                while ((uintptr_t) r % sizeof (size_t) == 0 && (size_t) (end - r) >= sizeof (size_t)) {
+                    size_t v;
+                    memcpy (&v, r, sizeof (v));
+                    if ((v & highs) || ((v - ones) & ~v & highs)) // non-ASCII or 0 byte in the word
+                        break;
+                    size_t a = v + ones * (0x80 - first);
+                    size_t z = v + ones * (0x7F - last);
+                    v ^= ((a & ~z) & highs) >> 2;               // flip 0x20 bit of letters in [first, last]
+                    memcpy (w, &v, sizeof (v));
+                    r += sizeof (v);
+                    w += sizeof (v);
+                }
+            #endif
+            unsigned char c = (unsigned char) *r;
+            if (c < 0x80) {
+                if (!c)
+                    break;
+                *w ++ = (char) (c >= first && c <= last ? c ^ 0x20 : c);
+                r ++;
+                continue;
+            }
+            // multi-byte character, invalid sequences decode into U+FFFD which doesn't map so they are copied as they are
+            const char *next = r;
+            uint32_t codepoint = __utf8Decode__ (next);
+            int consumed = next - r;
+            uint32_t mapped = __mapCase__ (codepoint, table, count);
+            char encoded [4];
+            int encodedLength;
+            if (mapped != codepoint && (encodedLength = __utf8Encode__ (mapped, encoded)) <= consumed) {
+                memcpy (w, encoded, encodedLength);
+                w += encodedLength;
+            } else {
+                memmove (w, r, consumed);
+                w += consumed;
+            }
+            r = next;
+        }
+        *w = 0;
+    }
+
+
     // ----- The default locale - ASCII locale, which is also a base class for all other locales -----
 
     class locale {
         public:
-            // list of supported locales
-            locale *nextLocale = NULL;
-
             // locale name
             virtual inline const char* name () const { return "ASCII"; }
 
             // lc_collate
+            virtual inline const collationWeight *getCollationTable (size_t& count) const { count = 0; return NULL; }
+
+            inline uint32_t getCollationWeight (uint32_t codepoint) const {
+                size_t count;
+                const collationWeight *table = getCollationTable (count);
+                // binary search
+                size_t low = 0;
+                while (count > low) {
+                    size_t middle = (low + count) / 2;
+                    if (table [middle].codepoint < codepoint)
+                        low = middle + 1;
+                    else if (table [middle].codepoint > codepoint)
+                        count = middle;
+                    else
+                        return table [middle].weight;
+                }
+                return codepoint << 2;
+            }
+
             virtual inline int strcoll (const char *s1, const char *s2) {
-                return strcmp (s1, s2);
+                size_t count;
+                if (!getCollationTable (count)) // without the table weights are in code point order and so are UTF-8 bytes
+                    return strcmp (s1, s2);
+                while (true) {
+                    uint32_t w1 = getCollationWeight (__utf8Decode__ (s1));
+                    uint32_t w2 = getCollationWeight (__utf8Decode__ (s2));
+                    if (w1 != w2)
+                        return w1 < w2 ? -1 : 1;
+                    if (!w1)
+                        return 0; // both strings ended
+                }
+            }
+
+            // transforms src into a binary sort key of 3 bytes per character, memcmp of two keys, followed by comparison of their lengths, gives the same result as strcoll,
+            // writes at most n bytes into dest and returns the length of the whole key, unlike strxfrm the key may include 0 bytes and is not 0 terminated
+            virtual inline size_t collkey (char *dest, const char *src, size_t n) {
+                size_t length = 0;
+                while (*src) {
+                    uint32_t w = getCollationWeight (__utf8Decode__ (src));
+                    if (length + 3 <= n) {
+                        dest [length] = (char) (w >> 16);
+                        dest [length + 1] = (char) (w >> 8);
+                        dest [length + 2] = (char) w;
+                    }
+                    length += 3;
+                }
+                return length;
             }
 
             // lc_ctype
+            virtual inline const caseMapping *getToUpperTable (size_t& count) const { count = 0; return NULL; } // only ASCII
+            virtual inline const caseMapping *getToLowerTable (size_t& count) const { count = 0; return NULL; } // only ASCII
+
+            // converts ps in-place, the string may get shorter
             virtual inline bool toupper (char *ps) {
-                while (*ps) {
-                    if (*ps >= 'a' && *ps <= 'z')
-                        *ps = (*ps - ('a' - 'A'));
-                    ps ++;
-                }
+                size_t count;
+                const caseMapping *table = getToUpperTable (count);
+                __convertCase__ (ps, true, table, count);
                 return true;
             }
 
             virtual inline bool tolower (char *ps) {
-                while (*ps) {
-                    if (*ps >= 'A' && *ps <= 'Z')
-                        *ps = (*ps + ('a' - 'A'));
-                    ps ++;
-                }
+                size_t count;
+                const caseMapping *table = getToLowerTable (count);
+                __convertCase__ (ps, false, table, count);
                 return true;
-            }            
+            }
 
             // lc_numeric
             virtual inline char getDecimalSeparator () const { return '.'; }
             virtual inline char getThousandsSeparator () const { return ','; }
+            virtual inline uint8_t getGrouping () const { return 3; } // the number of digits in a group
+            virtual inline char getPositiveSign () const { return '+'; }
+            virtual inline char getNegativeSign () const { return '-'; }
             // lc_time
             virtual inline const char* getTimeFormat () const { return "%Y/%m/%d %r"; }
     };
@@ -142,6 +423,8 @@
             // locale name
             inline const char* name () const override { return "en_150.UTF-8"; }
             // lc_ctype
+            inline const caseMapping *getToUpperTable (size_t& count) const override { count = sizeof (latinToUpper) / sizeof (latinToUpper [0]); return latinToUpper; }
+            inline const caseMapping *getToLowerTable (size_t& count) const override { count = sizeof (latinToLower) / sizeof (latinToLower [0]); return latinToLower; }
             // lc_numeric
             inline char getDecimalSeparator () const override { return ','; }
             inline char getThousandsSeparator () const override { return '.'; }
@@ -149,24 +432,98 @@
             inline const char* getTimeFormat () const override { return "%d/%m/%Y %H:%M:%S"; }
     };
 
-    // Add new locale instance to the supported locale list
-    inline bool addlocale (locale *loc) {
-        if (loc->name () == NULL) // only the default locale has no ID string
-            return false;
+    // ----- Locale registry -----
 
-        locale *p = &default_locale;
-        while (p->nextLocale != NULL) {
-            if (!strcmp (p->name (), loc->name ()))
-                return false;
-            p = p->nextLocale;
+    // FNV-1a hash of locale name, constexpr so that it can also be calculated at compile time
+    constexpr uint32_t __localeHash__ (const char *name, uint32_t hash = 2166136261u) {
+        return *name ? __localeHash__ (name + 1, (hash ^ (uint8_t) *name) * 16777619u) : hash;
+    }
+
+    // registered locales are indexed by their IDs, the default locale has ID 0, names are looked up in an open addressing hash table of IDs twice as large
+    #ifdef ARDUINO_ARCH_AVR
+        extern locale *__locales__ [__LOCALE_REGISTRY_SIZE__];
+        locale *__locales__ [__LOCALE_REGISTRY_SIZE__] = {};
+        extern uint32_t __localeHashes__ [__LOCALE_REGISTRY_SIZE__];
+        uint32_t __localeHashes__ [__LOCALE_REGISTRY_SIZE__] = {};
+        extern uint8_t __localeSlots__ [2 * __LOCALE_REGISTRY_SIZE__];
+        uint8_t __localeSlots__ [2 * __LOCALE_REGISTRY_SIZE__] = {};  // ID + 1, 0 for empty slot
+        extern uint8_t __localeCount__;
+        uint8_t __localeCount__ = 0;
+    #else
+        inline locale *__locales__ [__LOCALE_REGISTRY_SIZE__] = {};
+        inline uint32_t __localeHashes__ [__LOCALE_REGISTRY_SIZE__] = {};
+        inline uint8_t __localeSlots__ [2 * __LOCALE_REGISTRY_SIZE__] = {};  // ID + 1, 0 for empty slot
+        inline uint8_t __localeCount__ = 0;
+    #endif
+
+    // returns the ID of the locale with the name or -1 if the locale is not registered, the slot where it should be is returned in slot
+    inline int __findLocale__ (const char *name, uint32_t hash, uint8_t& slot) {
+        slot = hash & (2 * __LOCALE_REGISTRY_SIZE__ - 1);
+        while (__localeSlots__ [slot]) {
+            uint8_t id = __localeSlots__ [slot] - 1;
+            if (__localeHashes__ [id] == hash && !strcmp (__locales__ [id]->name (), name))
+                return id;
+            slot = (slot + 1) & (2 * __LOCALE_REGISTRY_SIZE__ - 1);
         }
+        return -1;
+    }
 
-        p->nextLocale = loc;
+    inline bool __registerLocale__ (locale *loc) {
+        uint32_t hash = __localeHash__ (loc->name ());
+        uint8_t slot;
+        if (__findLocale__ (loc->name (), hash, slot) >= 0 || __localeCount__ == __LOCALE_REGISTRY_SIZE__)
+            return false;
+        __locales__ [__localeCount__] = loc;
+        __localeHashes__ [__localeCount__] = hash;
+        __localeSlots__ [slot] = ++ __localeCount__;
         return true;
+    }
+
+    // Add a (statically allocated) locale instance to the registry of supported locales
+    inline bool addlocale (locale *loc) {
+        if (loc->name () == NULL)
+            return false;
+        if (!__localeCount__) // the default locale always gets ID 0
+            __registerLocale__ (&default_locale);
+        return __registerLocale__ (loc);
     };
 
+    // returns the ID of the registered locale, that can be used with setlocale, or -1 if the locale is not registered
+    inline int localeid (const char *name) {
+        uint8_t slot;
+        return __findLocale__ (name, __localeHash__ (name), slot);
+    }
+
     // Create a working instance and insert it into supported locale list
-    bool __locale_en_150_UTF_8__ = addlocale (new en_150_UTF_8_locale);
+    #ifdef ARDUINO_ARCH_AVR
+        extern en_150_UTF_8_locale __en_150_UTF_8_locale__;
+        en_150_UTF_8_locale __en_150_UTF_8_locale__;
+        extern bool __locale_en_150_UTF_8__;
+        bool __locale_en_150_UTF_8__ = addlocale (&__en_150_UTF_8_locale__);
+    #else
+        inline en_150_UTF_8_locale __en_150_UTF_8_locale__;
+        inline bool __locale_en_150_UTF_8__ = addlocale (&__en_150_UTF_8_locale__);
+    #endif
+
+    // numeric facet: a snapshot of lc_numeric settings that setlocale publishes, so formatting and parsing read them directly instead of calling virtual functions for each character
+    #ifndef __NUMERIC_FACET__
+        #define __NUMERIC_FACET__
+
+        struct numericFacet {
+            char decimalSeparator;
+            char thousandsSeparator;
+            uint8_t grouping;       // the number of digits in a group, 0 for no grouping
+            char positiveSign;
+            char negativeSign;
+        };
+
+        #ifdef ARDUINO_ARCH_AVR
+            extern numericFacet lc_numeric_facet;
+            numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #else
+            inline numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #endif
+    #endif
 
     // setlocale
     #ifdef ARDUINO_ARCH_AVR
@@ -185,14 +542,10 @@
         inline locale *lc_time_locale = &default_locale;
     #endif
 
-    inline bool setlocale (localeCategory_t category, const char *name) {
-        // find locale with name
-        locale *p = &default_locale;
-        while (p && strcmp (p->name (), name))
-            p = p->nextLocale;
-
-        if (!p) // not found
+    inline bool setlocale (localeCategory_t category, int id) {
+        if (id < 0 || id >= __localeCount__) // not registered
             return false;
+        locale *p = __locales__ [id];
 
         if (category & lc_collate)
             lc_collate_locale = p;
@@ -200,25 +553,141 @@
         if (category & lc_ctype)
             lc_ctype_locale = p;
 
-        if (category & lc_numeric)
+        if (category & lc_numeric) {
             lc_numeric_locale = p;
+            // publish the snapshot that ostream and istream use
+            lc_numeric_facet.decimalSeparator = p->getDecimalSeparator ();
+            lc_numeric_facet.thousandsSeparator = p->getThousandsSeparator ();
+            lc_numeric_facet.grouping = p->getGrouping ();
+            lc_numeric_facet.positiveSign = p->getPositiveSign ();
+            lc_numeric_facet.negativeSign = p->getNegativeSign ();
+        }
 
-        #ifndef ARDUINO_ARCH_AVR
-            if (category & lc_time)
-                lc_time_locale = p;
-        #endif
+        if (category & lc_time)
+            lc_time_locale = p;
 
         return true;
     }
 
+    inline bool setlocale (localeCategory_t category, const char *name) { return setlocale (category, localeid (name)); }
+
     // strcoll
     inline int strcoll (const char *s1, const char *s2) { return lc_collate_locale->strcoll (s1, s2); } 
     inline int strcoll (String& s1, String& s2) { return lc_collate_locale->strcoll ((char *) s1.c_str (), (char *) s2.c_str ()); } 
 
+    // collkey, a binary sort key (not a C string, so it is not called strxfrm)
+    inline size_t collkey (char *dest, const char *src, size_t n) { return lc_collate_locale->collkey (dest, src, n); }
+    inline size_t collkey (char *dest, String& src, size_t n) { return lc_collate_locale->collkey (dest, src.c_str (), n); }
+
+    // collsort
+    struct __sortEntry__ {
+        const char *key;
+        size_t length;
+        size_t index;
+    };
+
+    inline int __compareSortEntries__ (const void *a, const void *b) {
+        const __sortEntry__ *ea = (const __sortEntry__ *) a;
+        const __sortEntry__ *eb = (const __sortEntry__ *) b;
+        int c = memcmp (ea->key, eb->key, ea->length < eb->length ? ea->length : eb->length);
+        if (c)
+            return c;
+        return ea->length < eb->length ? -1 : ea->length > eb->length;
+    }
+
+    inline const char *__sortString__ (const char *s) { return s; }
+    inline const char *__sortString__ (const String& s) { return s.c_str (); }
+
+    template<typename S>
+    size_t __collkeysSize__ (const S *strings, size_t n) {
+        size_t keysSize = 0;
+        for (size_t i = 0; i < n; i++)
+            keysSize += lc_collate_locale->collkey (NULL, __sortString__ (strings [i]), 0);
+        return keysSize;
+    }
+
+    // each string is transformed into its sort key only once, the keys follow the n entries and are compared with memcmp
+    template<typename S>
+    void __collsort__ (S *strings, size_t n, __sortEntry__ *entries, size_t keysSize) {
+        char *key = (char *) (entries + n);
+        for (size_t i = 0; i < n; i++) {
+            entries [i] = { key, lc_collate_locale->collkey (key, __sortString__ (strings [i]), keysSize), i };
+            key += entries [i].length;
+            keysSize -= entries [i].length;
+        }
+        qsort (entries, n, sizeof (__sortEntry__), __compareSortEntries__);
+
+        // entries [i].index is now the index of the string that belongs to position i, move the strings following the cycles of this permutation
+        for (size_t i = 0; i < n; i++) {
+            if (entries [i].index == i)
+                continue;
+            S tmp = strings [i];
+            size_t j = i;
+            while (true) {
+                size_t k = entries [j].index;
+                entries [j].index = j;
+                if (k == i) {
+                    strings [j] = tmp;
+                    break;
+                }
+                strings [j] = strings [k];
+                j = k;
+            }
+        }
+    }
+
+    // sorts an array of strings (const char * or String) according to lc_collate, the memory for sort keys (n entries of 3 words plus 3 bytes per character) is taken with malloc
+    // for the time of sorting, returns false if there is not enough memory
+    template<typename S>
+    bool collsort (S *strings, size_t n) {
+        if (n < 2)
+            return true;
+        size_t keysSize = __collkeysSize__ (strings, n);
+        __sortEntry__ *entries = (__sortEntry__ *) malloc (n * sizeof (__sortEntry__) + keysSize);
+        if (!entries)
+            return false;
+        __collsort__ (strings, n, entries, keysSize);
+        free (entries);
+        return true;
+    }
+
+    // the size of the buffer that collsort (strings, n, buffer, bufferSize) needs
+    template<typename S>
+    size_t collsortBufferSize (const S *strings, size_t n) { return n * sizeof (__sortEntry__) + __collkeysSize__ (strings, n) + alignof (__sortEntry__) - 1; }
+
+    // the same without malloc, in the buffer given, returns false if the buffer is too small
+    template<typename S>
+    bool collsort (S *strings, size_t n, void *buffer, size_t bufferSize) {
+        if (n < 2)
+            return true;
+        size_t padding = (alignof (__sortEntry__) - (uintptr_t) buffer % alignof (__sortEntry__)) % alignof (__sortEntry__);
+        size_t keysSize = __collkeysSize__ (strings, n);
+        if (bufferSize < padding + n * sizeof (__sortEntry__) + keysSize)
+            return false;
+        __collsort__ (strings, n, (__sortEntry__ *) ((char *) buffer + padding), keysSize);
+        return true;
+    }
+
     // toupper, tolower
     inline bool toupper (char *cp) { return lc_ctype_locale->toupper (cp); }
-    inline bool toupper (String& s) { return lc_ctype_locale->toupper ((char *) s.c_str ()); }
+    inline bool toupper (String& s) {
+        size_t length = s.length ();
+        bool b = lc_ctype_locale->toupper ((char *) s.c_str ());
+        if (strlen (s.c_str ()) != length) { // the string got shorter, let String know
+            String t = s.c_str ();
+            s = t;
+        }
+        return b;
+    }
     inline bool tolower (char *cp) { return lc_ctype_locale->tolower (cp); }
-    inline bool tolower (String& s) { return lc_ctype_locale->tolower ((char *) s.c_str ()); }
+    inline bool tolower (String& s) {
+        size_t length = s.length ();
+        bool b = lc_ctype_locale->tolower ((char *) s.c_str ());
+        if (strlen (s.c_str ()) != length) { // the string got shorter, let String know
+            String t = s.c_str ();
+            s = t;
+        }
+        return b;
+    }
 
 #endif
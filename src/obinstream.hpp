@@ -0,0 +1,275 @@
+/*
+ *  obinstream.hpp for Arduino
+ *
+ *  This file is part of cin, cout library for Arduino: https://github.com/BojanJurca/cin-cout-for-Arduino
+ *
+ *  February 6, 2026, Bojan Jurca
+ *
+ */
+
+
+#ifndef __OBINSTREAM_HPP__
+    #define __OBINSTREAM_HPP__
+
+    #include "ostream.hpp"
+
+
+    // ----- TUNNING PARAMETERS -----
+
+    #ifndef __OBINSTREAM_RECORD_SIZE__
+        #ifdef ARDUINO_ARCH_AVR
+            #define __OBINSTREAM_RECORD_SIZE__ 32   // the maximum size of encoded values of one record, records that don't fit are discarded and counted in statistics ().droppedRecords
+        #else
+            #define __OBINSTREAM_RECORD_SIZE__ 128  // the maximum size of encoded values of one record, records that don't fit are discarded and counted in statistics ().droppedRecords
+        #endif
+    #endif
+
+
+    // ----- CODE -----
+
+
+    // binary output modes, cout << binary << a << b << c; writes one record with a, b and c encoded instead of formatted, the record ends with the statement
+    enum ostreamBinaryMode {
+        binary,     // integers are written as varints (signed ones zig-zag encoded), so small values take fewer bytes
+        binaryLE    // integers are written in fixed width little-endian order (sizeof the type)
+    };
+
+    // floats are written as 4 bytes and doubles as 8 bytes (4 on AVR boards) in little-endian order, bool and char as 1 byte, strings as varint length followed by the characters,
+    // struct tm as 6 bytes: tm_year - 100, tm_mon, tm_mday, tm_hour, tm_min, tm_sec
+    //
+    // on the wire each record is followed by its CRC-16/CCITT (little-endian), encoded with COBS and terminated by 0, so the receiver can always resynchronize on the next 0
+    //
+    // records go through the stream's buffer like text, so with the default flushOnEndl policy a record waits there until the next << flush, endl or '\n' in text output, or
+    // until the buffer fills up (a 0x0A byte inside a record may flush it earlier), use cout << binary << ... << flush or the unitbuf policy to send each record right away
+
+    // CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+    inline uint16_t __crc16__ (const uint8_t *buf, size_t len) {
+        uint16_t crc = 0xFFFF;
+        while (len --) {
+            crc ^= (uint16_t) *buf ++ << 8;
+            for (uint8_t i = 0; i < 8; i++)
+                crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        return crc;
+    }
+
+
+    class obinstream {
+
+        public:
+
+            obinstream (ostream& os, ostreamBinaryMode mode) : __os__ (&os), __mode__ (mode) {}
+
+            obinstream (const obinstream&) = delete;
+            obinstream (obinstream&& other) : __os__ (other.__os__), __mode__ (other.__mode__), __length__ (other.__length__), __overflow__ (other.__overflow__) {
+                memcpy (__record__, other.__record__, __length__);
+                other.__os__ = NULL; // only one of them writes the record
+            }
+
+            // the record is written when the statement ends
+            ~obinstream () { __writeRecord__ (); }
+
+            // integers
+            inline obinstream& operator << (short value) { return __signedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (unsigned short value) { return __unsignedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (int value) { return __signedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (unsigned int value) { return __unsignedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (long value) { return __signedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (unsigned long value) { return __unsignedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (long long value) { return __signedInteger__ (value, sizeof (value)); }
+            inline obinstream& operator << (unsigned long long value) { return __unsignedInteger__ (value, sizeof (value)); }
+
+            inline obinstream& operator << (bool value) { return __put__ ((uint8_t) value); }
+            inline obinstream& operator << (char value) { return __put__ ((uint8_t) value); }
+
+            // floating points
+            inline obinstream& operator << (float value) {
+                uint32_t u;
+                memcpy (&u, &value, sizeof (u));
+                return __littleEndian__ (u, sizeof (u));
+            }
+
+            inline obinstream& operator << (double value) {
+                if (sizeof (double) == 4) // only 4 bytes on AVR boards
+                    return *this << (float) value;
+                uint64_t u;
+                memcpy (&u, &value, sizeof (u));
+                return __littleEndian__ (u, sizeof (u));
+            }
+
+            // strings
+            inline obinstream& operator << (const char *value) {
+                size_t len = strlen (value);
+                __varint__ (len);
+                for (size_t i = 0; i < len; i++)
+                    __put__ ((uint8_t) value [i]);
+                return *this;
+            }
+
+            #ifndef ARDUINO_ARCH_AVR
+                inline obinstream& operator << (const struct tm& value) {
+                    __put__ ((uint8_t) (value.tm_year - 100));
+                    __put__ ((uint8_t) value.tm_mon);
+                    __put__ ((uint8_t) value.tm_mday);
+                    __put__ ((uint8_t) value.tm_hour);
+                    __put__ ((uint8_t) value.tm_min);
+                    return __put__ ((uint8_t) value.tm_sec);
+                }
+            #endif
+
+            // ends the record before the end of the statement, the following values go into a new record
+            inline obinstream& operator << (ostreamManipulator manipulator) {
+                if (manipulator == endl || manipulator == ::flush) {
+                    __writeRecord__ ();
+                    if (manipulator == ::flush)
+                        __os__->flush ();
+                }
+                return *this;
+            }
+
+        private:
+
+            ostream *__os__;
+            ostreamBinaryMode __mode__;
+            uint8_t __record__ [__OBINSTREAM_RECORD_SIZE__ + 2]; // + CRC
+            size_t __length__ = 0;
+            bool __overflow__ = false;
+
+            inline obinstream& __put__ (uint8_t b) {
+                if (__length__ < __OBINSTREAM_RECORD_SIZE__)
+                    __record__ [__length__ ++] = b;
+                else
+                    __overflow__ = true;
+                return *this;
+            }
+
+            template<typename U>
+            inline obinstream& __littleEndian__ (U value, size_t size) {
+                while (size --) {
+                    __put__ ((uint8_t) value);
+                    value >>= 8;
+                }
+                return *this;
+            }
+
+            template<typename U>
+            inline obinstream& __varint__ (U value) {
+                while (value >= 0x80) {
+                    __put__ ((uint8_t) (value | 0x80));
+                    value >>= 7;
+                }
+                return __put__ ((uint8_t) value);
+            }
+
+            inline obinstream& __unsignedInteger__ (unsigned long long value, size_t size) {
+                if (__mode__ == binaryLE)
+                    return __littleEndian__ (value, size);
+                if (value <= 0xFFFFFFFF)
+                    return __varint__ ((uint32_t) value); // 32 bit shifts are much faster on AVR
+                return __varint__ (value);
+            }
+
+            inline obinstream& __signedInteger__ (long long value, size_t size) {
+                if (__mode__ == binaryLE)
+                    return __littleEndian__ ((unsigned long long) value, size);
+                return __unsignedInteger__ (((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63), size); // zig-zag: 0, -1, 1, -2, 2, ... -> 0, 1, 2, 3, 4, ...
+            }
+
+            // appends CRC, writes the record COBS encoded and terminated by 0, records that didn't fit are discarded and counted in the stream's statistics
+            inline void __writeRecord__ () {
+                if (!__os__ || (!__length__ && !__overflow__))
+                    return;
+                if (__overflow__) {
+                    __STREAM_STAT__ (__os__->__statistics__.droppedRecords ++);
+                } else {
+                    uint16_t crc = __crc16__ (__record__, __length__);
+                    __record__ [__length__ ++] = (uint8_t) crc;
+                    __record__ [__length__ ++] = (uint8_t) (crc >> 8);
+
+                    // COBS: each block of up to 254 non-zero bytes is preceded by its length + 1, which replaces the 0 that follows the block
+                    uint8_t frame [__OBINSTREAM_RECORD_SIZE__ + 2 + (__OBINSTREAM_RECORD_SIZE__ + 2) / 254 + 2];
+                    size_t codeIndex = 0;
+                    size_t f = 1;
+                    uint8_t code = 1;
+                    for (size_t i = 0; i < __length__; i++) {
+                        if (__record__ [i]) {
+                            frame [f ++] = __record__ [i];
+                            code ++;
+                        }
+                        if (!__record__ [i] || code == 0xFF) {
+                            frame [codeIndex] = code;
+                            codeIndex = f ++;
+                            code = 1;
+                        }
+                    }
+                    frame [codeIndex] = code;
+                    frame [f ++] = 0; // frame delimiter
+                    __os__->write ((const char *) frame, f);
+                }
+                __length__ = 0;
+                __overflow__ = false;
+            }
+    };
+
+    // cout << binary starts a binary record
+    inline obinstream operator << (ostream& os, ostreamBinaryMode mode) { return obinstream (os, mode); }
+
+
+    // ----- decoding on the receiving side -----
+
+    // decodes a frame (without its terminating 0) into record and checks its CRC, returns the length of the record without CRC or -1 if the frame is corrupt
+    inline int obinDecode (const uint8_t *frame, size_t len, uint8_t *record) {
+        size_t length = 0;
+        size_t i = 0;
+        while (i < len) {
+            uint8_t code = frame [i ++];
+            if (!code || i + code - 1 > len)
+                return -1;
+            for (uint8_t j = 1; j < code; j++)
+                record [length ++] = frame [i ++];
+            if (code < 0xFF && i < len)
+                record [length ++] = 0;
+        }
+        if (length < 2 || __crc16__ (record, length - 2) != (record [length - 2] | (uint16_t) record [length - 1] << 8))
+            return -1;
+        return (int) length - 2;
+    }
+
+    // readers of the decoded record, p moves past the value
+    inline unsigned long long obinReadVarint (const uint8_t *&p) {
+        unsigned long long value = 0;
+        uint8_t shift = 0;
+        do {
+            value |= (unsigned long long) (*p & 0x7F) << shift;
+            shift += 7;
+        } while (*p ++ & 0x80);
+        return value;
+    }
+
+    inline long long obinReadZigzag (const uint8_t *&p) {
+        unsigned long long u = obinReadVarint (p);
+        return (long long) (u >> 1) ^ -(long long) (u & 1);
+    }
+
+    inline unsigned long long obinReadLittleEndian (const uint8_t *&p, size_t size) {
+        unsigned long long value = 0;
+        for (size_t i = 0; i < size; i++)
+            value |= (unsigned long long) *p ++ << (8 * i);
+        return value;
+    }
+
+    inline float obinReadFloat (const uint8_t *&p) {
+        uint32_t u = (uint32_t) obinReadLittleEndian (p, 4);
+        float f;
+        memcpy (&f, &u, sizeof (f));
+        return f;
+    }
+
+    inline double obinReadDouble (const uint8_t *&p) {
+        uint64_t u = obinReadLittleEndian (p, 8);
+        double d;
+        memcpy (&d, &u, sizeof (d));
+        return d;
+    }
+
+#endif
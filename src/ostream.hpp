@@ -12,22 +12,60 @@
     #define __OSTREAM_HPP__
 
 
+    // vector.hpp, queue.hpp, list.hpp and Map.hpp define their own operator << only if ostream.hpp is already included, it is more specialized than the generic
+    // ostream::operator << (const T&), so it is the one that gets called, without it their containers are printed as ranges (if they have const begin () and end ())
     #ifdef __VECTOR_HPP__
-        #pragma message "Include ostream.hpp prior to including vector.hpp to be able to cout << vector"
+        #pragma message "vector.hpp is included before ostream.hpp, cout << vector prints it as a range instead of with vector.hpp's operator <<"
     #endif
     #ifdef __QUEUE_HPP__
-        #pragma message "Include ostream.hpp prior to including queue.hpp to be able to cout << queue"
+        #pragma message "queue.hpp is included before ostream.hpp, cout << queue prints it as a range instead of with queue.hpp's operator <<"
     #endif
     #ifdef __LIST_HPP__
-        #pragma message "Include ostream.hpp prior to including list.hpp to be able to cout << list"
+        #pragma message "list.hpp is included before ostream.hpp, cout << list prints it as a range instead of with list.hpp's operator <<"
     #endif
     #ifdef __MAP_HPP__
-        #pragma message "Include ostream.hpp prior to including Map.hpp to be able to cout << Map"
+        #pragma message "Map.hpp is included before ostream.hpp, cout << Map prints it as a range instead of with Map.hpp's operator <<"
+    #endif
+
+
+    // ----- TUNNING PARAMETERS -----
+
+    #ifndef __OSTREAM_BUFFER_SIZE__
+        #ifdef ARDUINO_ARCH_AVR
+            #define __OSTREAM_BUFFER_SIZE__ 32  // output is collected in internal buffer and written to Serial in one piece
+        #else
+            #define __OSTREAM_BUFFER_SIZE__ 128 // output is collected in internal buffer and written to Serial in one piece
+        #endif
+    #endif
+
+    #ifndef __OSTREAM_IDLE_TIMEOUT__
+        #define __OSTREAM_IDLE_TIMEOUT__ 20     // ms, flushOnIdle policy flushes the buffer if nothing has been written for this long
+    #endif
+
+    #ifndef __OSTREAM_QUEUE_SIZE__
+        #define __OSTREAM_QUEUE_SIZE__ 0        // bytes, define it (for example 256) before including the library to make cout asynchronous: flushed output is queued in RAM and sent by service () only as fast as Serial can accept it without blocking
+    #endif
+
+    // #define __STREAM_STATISTICS__            // define it before including the library to count bytes, device calls, formatted values, time spent in device calls, ... of each stream
+
+    #ifndef __TIMESTAMP_SIZE__
+        #ifdef ARDUINO_ARCH_AVR
+            #define __TIMESTAMP_SIZE__ 32       // the maximum length of a formatted timestamp
+            #define __TIMESTAMP_FIELDS__ 8      // the maximum number of conversions (%Y, %m, ...) in a time format, composite ones like %T count as 3
+        #else
+            #define __TIMESTAMP_SIZE__ 64       // the maximum length of a formatted timestamp
+            #define __TIMESTAMP_FIELDS__ 16     // the maximum number of conversions (%Y, %m, ...) in a time format, composite ones like %T count as 3
+        #endif
     #endif
 
 
     // ----- CODE -----
 
+    #include <time.h> // time_t and struct tm, also on AVR boards
+    #ifndef ARDUINO_ARCH_AVR
+        #include <atomic>
+    #endif
+
 
     // Serial initialization
     #ifndef __CINIT__
@@ -54,7 +92,26 @@
 
 
     // ostream
-    #define endl "\r\n"
+
+    // numeric facet: a snapshot of lc_numeric settings that setlocale publishes, so formatting and parsing read them directly instead of calling virtual functions for each character
+    #ifndef __NUMERIC_FACET__
+        #define __NUMERIC_FACET__
+
+        struct numericFacet {
+            char decimalSeparator;
+            char thousandsSeparator;
+            uint8_t grouping;       // the number of digits in a group, 0 for no grouping
+            char positiveSign;
+            char negativeSign;
+        };
+
+        #ifdef ARDUINO_ARCH_AVR
+            extern numericFacet lc_numeric_facet;
+            numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #else
+            inline numericFacet lc_numeric_facet = { '.', ',', 3, '+', '-' };
+        #endif
+    #endif
 
     enum ostreamManipulator {
         precision0 = 0,
@@ -81,12 +138,743 @@
         noshowpoint,
         defaultfloat,
         hexfloat,
-        // scientific, not (yet) supported
-        fixed
+        scientific,     // d.ddde+xx with precision decimals
+        fixed,
+        dec,            // integer base (dec by default), other bases print the bits of the value, so negative numbers appear in two's complement
+        hex,
+        oct,
+        bin,
+        uppercase,      // A - F in hexadecimal digits, X, B in base prefixes and E in floating point exponents
+        nouppercase,
+        showbase,       // 0x, 0 or 0b prefix for non-decimal bases
+        noshowbase,
+        left,           // padding up to setw width goes after the value
+        right,          // padding goes in front of the value (default)
+
+        // endl used to be a "\r\n" macro, endl and flush are global names now: where another endl or flush is visible (std::endl with using namespace std, a flush ()
+        // member function inside a class like ostream itself, ...) write ::endl and ::flush, what endl saves in device writes is measured by bench/ (cout << ... << endl)
+        endl,   // writes "\r\n" and flushes the buffer with flushOnEndl policy
+        flush   // writes the buffer to the output device regardless of the flush policy
+    };
+
+    enum ostreamFlushPolicy {
+        unitbuf,        // flush after each << operation
+        flushOnEndl,    // flush after << operation that wrote endl or '\n' (default)
+        flushWhenFull,  // flush only when the buffer is full or on flush
+        flushOnIdle     // like flushWhenFull, but idle () also flushes the buffer if nothing has been written for __OSTREAM_IDLE_TIMEOUT__ ms
+    };
+
+    // what asynchronous ostream does when its output queue is full
+    enum ostreamOverflowPolicy {
+        blockWhenFull,  // wait until the device accepts enough of the queue (default)
+        dropNewest,     // discard what doesn't fit into the queue
+        dropOldest,     // discard the oldest queued bytes to make room
+        markDropped     // like dropNewest, but insert a [... bytes dropped] line once there is room again
     };
 
     #define setprecision(x) ((ostreamManipulator) x)
 
+    // cout << setw (8) << x pads the next number, character, C string or time to at least 8 characters (values printed by Print, like String, are not padded),
+    // the width is reset after each value, the fill character (setfill) stays until changed
+    struct __setw__ { int width; };
+    struct __setfill__ { char fill; };
+
+    inline __setw__ setw (int width) { return __setw__ { width }; }
+    inline __setfill__ setfill (char fill) { return __setfill__ { fill }; }
+
+    // compile-time formatting: cout << formatted<fixed, 3, showpoint> (x) prints x with the settings given as template parameters, the stream settings are neither read nor changed
+    template<ostreamManipulator fpOutput, int precision, ostreamManipulator grouping, typename T>
+    struct __formatted__ {
+        static_assert (fpOutput == defaultfloat || fpOutput == fixed || fpOutput == scientific || fpOutput == hexfloat, "formatted<> expects defaultfloat, fixed, scientific or hexfloat");
+        static_assert (precision >= 0 && precision <= 19, "formatted<> expects precision between 0 and 19");
+        static_assert (grouping == showpoint || grouping == noshowpoint, "formatted<> expects showpoint or noshowpoint");
+        T value;
+    };
+
+    template<ostreamManipulator fpOutput = defaultfloat, int precision = 6, ostreamManipulator grouping = noshowpoint, typename T>
+    inline __formatted__<fpOutput, precision, grouping, T> formatted (const T& value) {
+        return __formatted__<fpOutput, precision, grouping, T> { value };
+    }
+
+    // range formatting: cout << rangeformat ("{ ", "; ", " }", 10) sets the brackets and the delimiter that containers, arrays and other ranges are printed with
+    // and the maximum number of elements printed (0 = all), the rest is replaced by ...
+    struct rangeFormat_t {
+        const char *open;
+        const char *separator;
+        const char *close;
+        size_t maxElements;
+    };
+
+    inline rangeFormat_t rangeformat (const char *open = "[", const char *separator = ", ", const char *close = "]", size_t maxElements = 0) {
+        return rangeFormat_t { open, separator, close, maxElements };
+    }
+
+    // compile-time detection of ranges and pairs, written without <type_traits> which is not available on AVR boards
+    template<typename T> T&& __declval__ (); // only used in unevaluated context
+
+    template<typename T>
+    struct __isRange__ { // has begin () and end () but is not a string (String and std::string have them too)
+        template<typename U, typename = decltype (__declval__<const U&> ().begin ()), typename = decltype (__declval__<const U&> ().end ())> static char __range__ (int);
+        template<typename U> static long __range__ (...);
+        template<typename U, typename = decltype (__declval__<const U&> ().c_str ())> static char __string__ (int);
+        template<typename U> static long __string__ (...);
+        static const bool value = sizeof (__range__<T> (0)) == 1 && sizeof (__string__<T> (0)) != 1;
+    };
+
+    template<typename T, size_t N>
+    struct __isRange__<T [N]> { static const bool value = true; };
+
+    template<typename T>
+    struct __isPair__ { // has first and second, like elements of std::map
+        template<typename U, typename = decltype (__declval__<const U&> ().first), typename = decltype (__declval__<const U&> ().second)> static char __pair__ (int);
+        template<typename U> static long __pair__ (...);
+        static const bool value = sizeof (__pair__<T> (0)) == 1;
+    };
+
+    template<int kind> struct __valueKind__ {}; // 0 = printed by Print, 1 = range, 2 = pair
+
+    // pairs of decimal digits "00" - "99" that integer formatting uses to convert two digits at a time
+    // PROGMEM tables are always read with pgm_read_byte, pgm_read_word or memcpy_P, not only on AVR: ESP8266 flash, for example, faults on byte and 16 bit loads
+    const char __digitPairs__ [201] PROGMEM = "00010203040506070809"
+                                              "10111213141516171819"
+                                              "20212223242526272829"
+                                              "30313233343536373839"
+                                              "40414243444546474849"
+                                              "50515253545556575859"
+                                              "60616263646566676869"
+                                              "70717273747576777879"
+                                              "80818283848586878889"
+                                              "90919293949596979899";
+
+    // digits of hexadecimal, octal and binary numbers, looked up one nibble (or less) at a time
+    const char __nibbleDigits__ [2][17] PROGMEM = { "0123456789abcdef", "0123456789ABCDEF" };
+
+    // ----- cached timestamp formatting -----
+
+    // broken-down time like struct tm, with milliseconds
+    struct __timeFields__ {
+        int year;               // 2026
+        uint8_t month;          // 1 - 12
+        uint8_t day;            // 1 - 31
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t second;
+        uint8_t weekday;        // 0 = Sunday
+        uint16_t yearday;       // 0 - 365
+        uint16_t millisecond;
+    };
+
+    inline __timeFields__ __tmToFields__ (const struct tm& t) {
+        return __timeFields__ { t.tm_year + 1900, (uint8_t) (t.tm_mon + 1), (uint8_t) t.tm_mday, (uint8_t) t.tm_hour, (uint8_t) t.tm_min, (uint8_t) t.tm_sec, (uint8_t) t.tm_wday, (uint16_t) t.tm_yday, 0 };
+    }
+
+    // converts Unix time (seconds since 1970/01/01 UTC) to calendar fields without the C library, days to civil date algorithm by Howard Hinnant
+    inline void __unixToFields__ (long long t, __timeFields__& f) {
+        long days = (long) (t / 86400);
+        long seconds = (long) (t % 86400);
+        if (seconds < 0) {
+            seconds += 86400;
+            days --;
+        }
+        f.hour = seconds / 3600;
+        f.minute = seconds / 60 % 60;
+        f.second = seconds % 60;
+        f.millisecond = 0;
+        f.weekday = (days % 7 + 11) % 7; // 1970/01/01 was Thursday
+
+        days += 719468; // days since 0000/03/01
+        long era = (days >= 0 ? days : days - 146096) / 146097;
+        long dayOfEra = days - era * 146097;
+        long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100); // from March 1st
+        long mp = (5 * dayOfYear + 2) / 153;
+        f.day = dayOfYear - (153 * mp + 2) / 5 + 1;
+        f.month = mp < 10 ? mp + 3 : mp - 9;
+        f.year = (int) (yearOfEra + era * 400) + (f.month <= 2);
+
+        bool leap = f.year % 4 == 0 && (f.year % 100 != 0 || f.year % 400 == 0);
+        f.yearday = f.month > 2 ? dayOfYear + 59 + leap : dayOfYear - 306; // March 1st is the 59th (60th in leap years) day of the year, counting from 0
+    }
+
+    const char __weekdayNames__ [22] PROGMEM = "SunMonTueWedThuFriSat";
+    const char __monthNames__ [37] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    // formats time with strftime-like format, which is compiled into a template of literal text and fixed width fields only once, when the format changes,
+    // the rendered text is kept, so only the fields that changed since the previous call are rendered again (usually only the seconds)
+    //
+    // supported conversions: %Y %y %m %d %e %H %I %M %S %p %j %a %b %h %T %R %D %F %r %% and %L (milliseconds, not in strftime),
+    // the other ones are copied to the output as they are and complete () returns false
+    class timeFormatter {
+
+        public:
+
+            // returns the text of t formatted with format, length is set to its length
+            const char *format (const char *format, const __timeFields__& t, size_t& length) {
+                if (format != __format__)
+                    __compile__ (format);
+                for (uint8_t i = 0; i < __fieldCount__; i++) {
+                    int value = __value__ (__fields__ [i].conversion, t);
+                    if (value != __fields__ [i].value) {
+                        __fields__ [i].value = value;
+                        __render__ (__fields__ [i].conversion, value, __text__ + __fields__ [i].offset);
+                    }
+                }
+                length = __length__;
+                return __text__;
+            }
+
+            // the same for Unix time, which is converted to local time only when the hour changes, in between only the minutes and seconds are updated
+            const char *format (const char *format, time_t t, uint16_t millisecond, size_t& length) {
+                time_t hourStart = __lastTime__ - (__lastFields__.minute * 60 + __lastFields__.second);
+                if (__lastValid__ && t >= hourStart && t - hourStart < 3600) {
+                    long seconds = (long) (t - hourStart);
+                    __lastFields__.minute = seconds / 60;
+                    __lastFields__.second = seconds % 60;
+                } else {
+                    #ifdef ARDUINO_ARCH_AVR
+                        __unixToFields__ ((long long) t, __lastFields__); // UTC, there are no time zones on AVR boards
+                    #else
+                        struct tm tm;
+                        localtime_r (&t, &tm);
+                        __lastFields__ = __tmToFields__ (tm);
+                    #endif
+                    __lastValid__ = true;
+                }
+                __lastTime__ = t;
+                __lastFields__.millisecond = millisecond;
+                return this->format (format, __lastFields__, length);
+            }
+
+            // false if the format contains conversions that are not supported or doesn't fit into __TIMESTAMP_SIZE__ characters
+            inline bool complete () const { return __complete__; }
+
+            // a formatter can only be used by one task at a time, tryLock () returns false if another task is using it (there is only one task on AVR boards)
+            #ifndef ARDUINO_ARCH_AVR
+                inline bool tryLock () { return !__busy__.test_and_set (std::memory_order_acquire); }
+                inline void unlock () { __busy__.clear (std::memory_order_release); }
+            #else
+                inline bool tryLock () { return true; }
+                inline void unlock () {}
+            #endif
+
+        private:
+
+            #ifndef ARDUINO_ARCH_AVR
+                std::atomic_flag __busy__ = ATOMIC_FLAG_INIT;
+            #endif
+
+            struct __field__ {
+                char conversion;
+                uint8_t offset;     // in __text__
+                int value;          // the value currently rendered, -1 = not rendered yet
+            };
+
+            const char *__format__ = NULL; // compiled format
+            char __text__ [__TIMESTAMP_SIZE__ + 1];
+            uint8_t __length__ = 0;
+            __field__ __fields__ [__TIMESTAMP_FIELDS__];
+            uint8_t __fieldCount__ = 0;
+            bool __complete__ = true;
+
+            time_t __lastTime__ = 0;
+            __timeFields__ __lastFields__ = {};
+            bool __lastValid__ = false;
+
+            inline void __compile__ (const char *format) {
+                __format__ = format;
+                __length__ = __fieldCount__ = 0;
+                __complete__ = true;
+                __append__ (format);
+                __text__ [__length__] = 0;
+            }
+
+            // appends literal text and fields of format to the template
+            void __append__ (const char *format) {
+                for (const char *f = format; *f; f++) {
+                    if (*f == '%' && f [1]) {
+                        f ++;
+                        switch (*f) {
+                            case 'T':   __append__ ("%H:%M:%S"); continue;
+                            case 'R':   __append__ ("%H:%M"); continue;
+                            case 'D':   __append__ ("%m/%d/%y"); continue;
+                            case 'F':   __append__ ("%Y-%m-%d"); continue;
+                            case 'r':   __append__ ("%I:%M:%S %p"); continue;
+                            case '%':   __literal__ ('%'); continue;
+                        }
+                        uint8_t width = __width__ (*f);
+                        if (width && __fieldCount__ < __TIMESTAMP_FIELDS__ && __length__ + width <= __TIMESTAMP_SIZE__) {
+                            __fields__ [__fieldCount__ ++] = { *f, __length__, -1 };
+                            memset (__text__ + __length__, ' ', width);
+                            __length__ += width;
+                            continue;
+                        }
+                        __complete__ = false;
+                        __literal__ ('%');
+                    }
+                    __literal__ (*f);
+                }
+            }
+
+            inline void __literal__ (char c) {
+                if (__length__ < __TIMESTAMP_SIZE__)
+                    __text__ [__length__ ++] = c;
+                else
+                    __complete__ = false;
+            }
+
+            static inline uint8_t __width__ (char conversion) {
+                switch (conversion) {
+                    case 'Y':   return 4;
+                    case 'j':
+                    case 'L':
+                    case 'a':
+                    case 'b':
+                    case 'h':   return 3;
+                    case 'y':
+                    case 'm':
+                    case 'd':
+                    case 'e':
+                    case 'H':
+                    case 'I':
+                    case 'M':
+                    case 'S':
+                    case 'p':   return 2;
+                    default:    return 0; // not supported
+                }
+            }
+
+            static inline int __value__ (char conversion, const __timeFields__& t) {
+                switch (conversion) {
+                    case 'Y':   return t.year;
+                    case 'y':   return t.year % 100;
+                    case 'm':   return t.month;
+                    case 'b':
+                    case 'h':   return t.month - 1;
+                    case 'd':
+                    case 'e':   return t.day;
+                    case 'j':   return t.yearday + 1;
+                    case 'a':   return t.weekday;
+                    case 'H':   return t.hour;
+                    case 'I':   return t.hour % 12 ? t.hour % 12 : 12;
+                    case 'p':   return t.hour >= 12;
+                    case 'M':   return t.minute;
+                    case 'S':   return t.second;
+                    default:    return t.millisecond; // 'L'
+                }
+            }
+
+            static inline void __twoDigits__ (char *p, int value) {
+                p [0] = pgm_read_byte (&__digitPairs__ [2 * value]);
+                p [1] = pgm_read_byte (&__digitPairs__ [2 * value + 1]);
+            }
+
+            static inline void __name__ (char *p, const char *names, int index) {
+                memcpy_P (p, names + 3 * index, 3);
+            }
+
+            static inline void __render__ (char conversion, int value, char *p) {
+                switch (conversion) {
+                    case 'Y':   __twoDigits__ (p, value / 100 % 100);
+                                __twoDigits__ (p + 2, value % 100);
+                                break;
+                    case 'j':
+                    case 'L':   p [0] = '0' + value / 100;
+                                __twoDigits__ (p + 1, value % 100);
+                                break;
+                    case 'a':   __name__ (p, __weekdayNames__, value);
+                                break;
+                    case 'b':
+                    case 'h':   __name__ (p, __monthNames__, value);
+                                break;
+                    case 'p':   p [0] = value ? 'P' : 'A';
+                                p [1] = 'M';
+                                break;
+                    case 'e':   __twoDigits__ (p, value);
+                                if (p [0] == '0')
+                                    p [0] = ' ';
+                                break;
+                    default:    __twoDigits__ (p, value);
+                                break;
+                }
+            }
+    };
+
+    // cout << timestamp (t) prints Unix time t, cout << uptime () prints the time since the start as [days d] HH:MM:SS.mmm,
+    // both and struct tm are printed with lc_time format (%Y/%m/%d %T without locale.hpp) by cached formatters
+    struct __timestamp__ {
+        time_t time;
+        uint16_t millisecond;
+    };
+
+    struct __uptime__ {
+        unsigned long milliseconds;
+    };
+
+    inline __timestamp__ timestamp (time_t time, uint16_t millisecond = 0) { return __timestamp__ { time, millisecond }; }
+    inline __uptime__ uptime (unsigned long milliseconds = millis ()) { return __uptime__ { milliseconds }; }
+
+    // one formatter for each kind of timestamps, so they don't recompile each other's format, a stream that finds the formatter locked by another task
+    // renders its timestamp with a temporary formatter instead
+    #ifdef ARDUINO_ARCH_AVR
+        extern timeFormatter __timeFormatter__;
+        timeFormatter __timeFormatter__;
+        extern timeFormatter __uptimeFormatter__;
+        timeFormatter __uptimeFormatter__;
+    #else
+        inline timeFormatter __timeFormatter__;
+        inline timeFormatter __uptimeFormatter__;
+    #endif
+
+
+    // ----- shortest round-trip conversion of floating point numbers to decimal digits (Grisu2 algorithm by Florian Loitsch) -----
+
+    // "do it yourself floating point" number f * 2 ^ e
+    struct __diyFp__ {
+        uint64_t f;
+        int e;
+
+        __diyFp__ (uint64_t f, int e) : f (f), e (e) {}
+
+        inline __diyFp__ operator - (const __diyFp__& other) const { return __diyFp__ (f - other.f, e); }
+
+        inline __diyFp__ operator * (const __diyFp__& other) const { // upper 64 bits of 128 bit product, rounded
+            uint64_t a = f >> 32, b = f & 0xFFFFFFFF, c = other.f >> 32, d = other.f & 0xFFFFFFFF;
+            uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+            uint64_t tmp = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1ul << 31);
+            return __diyFp__ (ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + other.e + 64);
+        }
+
+        inline __diyFp__ normalize () const {
+            int s = __builtin_clzll (f);
+            return __diyFp__ (f << s, e - s);
+        }
+    };
+
+    // normalized 64 bit approximations of 10 ^ -348, 10 ^ -340, ..., 10 ^ 340
+    const uint64_t __cachedPowersF__ [87] PROGMEM = {
+        0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+        0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+        0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+        0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+        0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+        0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+        0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+        0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+        0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+        0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+        0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+        0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+        0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+        0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+        0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+        0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+        0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+        0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+        0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+        0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+        0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+        0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+        0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+        0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+        0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+        0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+        0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+        0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+        0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+    };
+    const int16_t __cachedPowersE__ [87] PROGMEM = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+        -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+        -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+        -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+        -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+        109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+        375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+        641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+        907, 933, 960, 986, 1013, 1039, 1066
+    };
+
+    // converts significand * 2 ^ exponent (significand includes the hidden bit at position significandBits) to the shortest string of decimal digits that reads back to the same value: digits * 10 ^ K, returns the number of digits
+    inline int __shortestDigits__ (uint64_t significand, int exponent, int significandBits, char *digits, int& K) {
+        static const uint32_t pow10 [] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+        // boundaries m- and m+ of the interval that rounds to the same value
+        __diyFp__ v (significand, exponent);
+        __diyFp__ mPlus (((v.f << 1) + 1) << (64 - significandBits - 2), v.e - 1 - (64 - significandBits - 2));
+        mPlus = mPlus.normalize ();
+        __diyFp__ mMinus = v.f == (1ull << significandBits) ? __diyFp__ ((v.f << 2) - 1, v.e - 2) : __diyFp__ ((v.f << 1) - 1, v.e - 1); // the lower boundary is closer at powers of 2
+        mMinus.f <<= mMinus.e - mPlus.e;
+        mMinus.e = mPlus.e;
+
+        // find cached power of 10 that brings the exponent of the product into [-60, -32]
+        int k = (int) (((int32_t) (-61 - mPlus.e) * 78913 + (1l << 18) - 1) >> 18) + 347; // ceil ((-61 - e) * log10 (2)) + 347
+        int index = (k >> 3) + 1;
+        K = -(-348 + index * 8);
+        uint64_t cf;
+        int16_t ce;
+        memcpy_P (&cf, &__cachedPowersF__ [index], sizeof (cf));
+        ce = (int16_t) pgm_read_word (&__cachedPowersE__ [index]);
+        __diyFp__ c (cf, ce);
+
+        __diyFp__ W = v.normalize () * c;
+        __diyFp__ Wp = mPlus * c;
+        __diyFp__ Wm = mMinus * c;
+        Wm.f ++;
+        Wp.f --;
+
+        // generate digits of Wp until they are within delta of W
+        uint64_t delta = Wp.f - Wm.f;
+        __diyFp__ one (1ull << -Wp.e, Wp.e);
+        uint64_t wpw = (Wp - W).f;
+        uint32_t p1 = (uint32_t) (Wp.f >> -one.e);
+        uint64_t p2 = Wp.f & (one.f - 1);
+        int kappa = 1;
+        while (kappa < 10 && p1 >= pow10 [kappa])
+            kappa ++;
+        int length = 0;
+        uint64_t rest, tenKappa;
+        while (true) {
+            if (kappa > 0) {
+                uint32_t d = p1 / pow10 [kappa - 1];
+                p1 %= pow10 [kappa - 1];
+                if (d || length)
+                    digits [length ++] = '0' + (char) d;
+                kappa --;
+                rest = ((uint64_t) p1 << -one.e) + p2;
+                if (rest <= delta) {
+                    tenKappa = (uint64_t) pow10 [kappa] << -one.e;
+                    break;
+                }
+            } else {
+                p2 *= 10;
+                delta *= 10;
+                char d = (char) (p2 >> -one.e);
+                if (d || length)
+                    digits [length ++] = '0' + d;
+                p2 &= one.f - 1;
+                kappa --;
+                if (p2 < delta) {
+                    rest = p2;
+                    tenKappa = one.f;
+                    wpw *= pow10 [-kappa];
+                    break;
+                }
+            }
+        }
+        K += kappa;
+
+        // round the last digit towards W
+        while (rest < wpw && delta - rest >= tenKappa && (rest + tenKappa < wpw || wpw - rest > rest + tenKappa - wpw)) {
+            digits [length - 1] --;
+            rest += tenKappa;
+        }
+        return length;
+    }
+
+    // unsigned integer of 32 bit words, just large enough for the exact decimal expansion of a floating point number (up to 1078 bits for double, 153 bits for float)
+    struct __bigInteger__ {
+        static const int capacity = sizeof (double) == 4 ? 6 : 35;
+        uint32_t word [capacity];
+        int size; // words in use, the most significant one is not 0
+
+        inline void set (uint64_t value) {
+            word [0] = (uint32_t) value;
+            word [1] = (uint32_t) (value >> 32);
+            size = word [1] ? 2 : word [0] ? 1 : 0;
+        }
+
+        inline void shiftLeft (int bits) {
+            if (!size)
+                return;
+            int words = bits / 32;
+            bits %= 32;
+            if (bits) {
+                uint32_t carry = 0;
+                for (int i = 0; i < size; i++) {
+                    uint32_t w = word [i];
+                    word [i] = (w << bits) | carry;
+                    carry = w >> (32 - bits);
+                }
+                if (carry)
+                    word [size ++] = carry;
+            }
+            if (words) {
+                memmove (word + words, word, size * sizeof (uint32_t));
+                memset (word, 0, words * sizeof (uint32_t));
+                size += words;
+            }
+        }
+
+        inline void multiply (uint32_t m) {
+            uint32_t carry = 0;
+            for (int i = 0; i < size; i++) {
+                uint64_t product = (uint64_t) word [i] * m + carry;
+                word [i] = (uint32_t) product;
+                carry = (uint32_t) (product >> 32);
+            }
+            if (carry)
+                word [size ++] = carry;
+        }
+
+        inline void multiplyPow10 (int n) {
+            static const uint32_t pow10 [] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+            for (; n >= 9; n -= 9)
+                multiply (pow10 [9]);
+            if (n)
+                multiply (pow10 [n]);
+        }
+
+        inline int compare (const __bigInteger__& other) const {
+            if (size != other.size)
+                return size < other.size ? -1 : 1;
+            for (int i = size - 1; i >= 0; i--)
+                if (word [i] != other.word [i])
+                    return word [i] < other.word [i] ? -1 : 1;
+            return 0;
+        }
+
+        inline void subtract (const __bigInteger__& other) { // other must not be larger
+            uint32_t borrow = 0;
+            for (int i = 0; i < size; i++) {
+                uint64_t difference = (uint64_t) word [i] - (i < other.size ? other.word [i] : 0) - borrow;
+                word [i] = (uint32_t) difference;
+                borrow = (uint32_t) (difference >> 63);
+            }
+            while (size && !word [size - 1])
+                size --;
+        }
+    };
+
+    // exact decimal digits of value = integer + fraction / 2 ^ fractionBits (fractionBits <= 60) in 64 bit arithmetic, see __exactDigits__
+    template<typename Digits>
+    inline void __exactDigits__ (uint64_t integer, uint64_t fraction, int fractionBits, Digits& out) {
+        char buf [20];
+        char *p = buf + sizeof (buf);
+        for (; integer; integer /= 10)
+            *-- p = '0' + (char) (integer % 10);
+        int length = buf + sizeof (buf) - p;
+        int point = length;
+        if (!length) // skip the leading zeros of the fraction
+            while (!((fraction * 10) >> fractionBits)) {
+                fraction *= 10;
+                point --;
+            }
+
+        int count = out.begin (point);
+        if (count < 0) { // the value is less than half of the last place
+            out.end (-1);
+            return;
+        }
+        int half;
+        if (count < length) { // scientific output of a large integer, compare the integer digits that don't fit with 500...
+            for (int i = 0; i < count; i++)
+                out.digit (p [i]);
+            half = p [count] - '5';
+            for (int i = count + 1; !half && i < length; i++)
+                half = p [i] != '0';
+            if (!half)
+                half = fraction != 0;
+        } else {
+            for (int i = 0; i < length; i++)
+                out.digit (p [i]);
+            uint64_t mask = ((uint64_t) 1 << fractionBits) - 1;
+            for (; length < count && fraction; length ++) {
+                fraction *= 10;
+                out.digit ('0' + (char) (fraction >> fractionBits));
+                fraction &= mask;
+            }
+            if (fraction) {
+                uint64_t halfPlace = (uint64_t) 1 << (fractionBits - 1);
+                half = fraction > halfPlace ? 1 : fraction == halfPlace ? 0 : -1;
+            } else {
+                half = -1; // the digits are exact
+            }
+        }
+        out.end (half);
+    }
+
+    // the same for values that don't fit into 64 bit fixed point, with arbitrary precision integers, kept out of line so that only this rare case takes their stack
+    template<typename Digits>
+    __attribute__((noinline)) void __exactDigitsBig__ (uint64_t significand, int exponent, Digits& out) {
+        __bigInteger__ r, s; // value = r / s * 10 ^ point, with r / s in [0.1, 1)
+        r.set (significand);
+        s.set (1);
+        if (exponent >= 0)
+            r.shiftLeft (exponent);
+        else
+            s.shiftLeft (-exponent);
+
+        // estimate point from the binary exponent, it may be one off in both directions
+        int point = (int) (((int32_t) (exponent + 63 - __builtin_clzll (significand)) * 78913) >> 18) + 1; // floor (log2 (value) * log10 (2)) + 1
+        if (point >= 0)
+            s.multiplyPow10 (point);
+        else
+            r.multiplyPow10 (-point);
+        while (r.compare (s) >= 0) {
+            s.multiply (10);
+            point ++;
+        }
+        r.multiply (10); // r / s in [1, 10) now, which gives the first digit
+        if (r.compare (s) < 0) {
+            r.multiply (10);
+            point --;
+        }
+
+        int count = out.begin (point);
+        for (int length = 0; length < count && r.size; length ++) {
+            char digit = '0';
+            while (r.compare (s) >= 0) {
+                r.subtract (s);
+                digit ++;
+            }
+            out.digit (digit);
+            r.multiply (10);
+        }
+        if (count < 0 || !r.size) { // the value is less than half of the last place or the digits are exact
+            out.end (-1);
+            return;
+        }
+        s.multiply (5); // r is 10 times the rest now, half of the last place is 5 s
+        out.end (r.compare (s));
+    }
+
+    // generates the exact decimal digits of significand * 2 ^ exponent (not 0) one at a time, rounded half to even (like printf), into out:
+    // out.begin (point) receives the position of the decimal point (value = 0.digits * 10 ^ point) and returns how many digits it needs, the digits follow with out.digit (d),
+    // out.end (half) tells whether the rest of the value is more (> 0), exactly (0) or less (< 0) than half of the last place, digits that are not generated are zeros
+    template<typename Digits>
+    inline void __exactDigits__ (uint64_t significand, int exponent, Digits& out) {
+        if (exponent < 0 && exponent >= -60)
+            __exactDigits__ (significand >> -exponent, significand & (((uint64_t) 1 << -exponent) - 1), -exponent, out);
+        else if (exponent >= 0 && 64 - __builtin_clzll (significand) + exponent <= 64)
+            __exactDigits__ (significand << exponent, 0, 0, out);
+        else
+            __exactDigitsBig__ (significand, exponent, out);
+    }
+
+
+    // stream statistics, compiled in only if __STREAM_STATISTICS__ is defined before including the library
+    #ifndef __STREAM_STAT__
+        #ifdef __STREAM_STATISTICS__
+            #define __STREAM_STAT__(x) x
+        #else
+            #define __STREAM_STAT__(x)
+        #endif
+    #endif
+
+    #ifdef __STREAM_STATISTICS__
+        struct ostreamStatistics {
+            unsigned long bytesWritten;     // bytes passed to the output device
+            unsigned long sinkCalls;        // writes to the output device
+            unsigned long sinkMicros;       // time spent in writes to the output device, like waiting for the full UART TX buffer
+            unsigned long integers;         // formatted values
+            unsigned long floatingPoints;
+            unsigned long strings;
+            unsigned long others;           // values formatted by Print, struct tm, ...
+            unsigned long truncations;      // output that didn't fit into the fixed buffer of ostringstream
+            unsigned long droppedRecords;   // binary records (obinstream.hpp) that didn't fit into __OBINSTREAM_RECORD_SIZE__ bytes
+        };
+    #endif
+
     class ostream {
 
         private:
@@ -94,14 +882,59 @@
             bool __showpoint__ = false;                     // not set by default
             ostreamManipulator __fpOutput__ = defaultfloat; // by default
             int __precision__ = 6;                          // default precision
-            char __floatFormat__ [6] = "%.6f";              // for default precision
-            char __doubleFormat__ [7] = "%.6lf";            // for default precision
-            char __longDoubleFormat__ [7] = "%.6Lf";        // for default precision
+            ostreamManipulator __base__ = dec;              // integer base
+            bool __uppercase__ = false;
+            bool __showbase__ = false;
+            bool __left__ = false;
+            int __width__ = 0;                              // minimum width of the next value, 0 = no padding
+            char __fill__ = ' ';
+
+            ostreamFlushPolicy __flushPolicy__ = flushOnEndl;
+            rangeFormat_t __rangeFormat__ = { "[", ", ", "]", 0 };
+            bool __endOfLine__ = false;
+            unsigned long __lastWrite__ = 0;
+
+            // lets Print::print format the types that ostream doesn't handle itself directly into the buffer
+            class __bufferPrint__ : public Print {
+                public:
+                    ostream *__os__;
+                    __bufferPrint__ (ostream *os) : __os__ (os) {}
+                    inline size_t write (uint8_t c) override { __os__->__put__ ((char) c); return 1; }
+                    inline size_t write (const uint8_t *buf, size_t len) override { __os__->__write__ ((const char *) buf, len); return len; }
+            };
+
+        protected:
+
+            char *__buffer__;                               // provided by the derived class
+            size_t __bufferSize__;
+            size_t __length__ = 0;
+            bool __fixedBuffer__;                           // the buffer is the final destination of the output (ostringstream), it never gets flushed, the 0 after the text is kept in place (one byte past __bufferSize__)
+            bool __truncated__ = false;                     // some output didn't fit into the fixed buffer
+
+            ostreamOverflowPolicy __overflowPolicy__ = blockWhenFull;
+
+            // writes buf to the output device, the only device dependent part of ostream, called once per flush
+            virtual void __sink__ (const char *buf, size_t len) = 0;
+
+            #ifdef __STREAM_STATISTICS__
+                ostreamStatistics __statistics__ = {};
+                friend class obinstream; // counts dropped records
+            #endif
 
         public:
 
+            ostream (char *buffer, size_t bufferSize, bool fixedBuffer = false) : __buffer__ (buffer), __bufferSize__ (bufferSize), __fixedBuffer__ (fixedBuffer) {}
+
+            virtual ~ostream () {}
+
+            // a copy would write into the buffer of the original, which may live inside the original (fixed_ostringstream, basic_ostream)
+            ostream (const ostream&) = delete;
+            ostream& operator = (const ostream&) = delete;
+
             inline ostream& operator << (const char* value) __attribute__((noinline)) {
-                Serial.print (value);
+                __STREAM_STAT__ (__statistics__.strings ++);
+                __writePadded__ (value, strlen (value));
+                __commit__ ();
                 return *this;
             }
 
@@ -110,64 +943,608 @@
                 return *this << static_cast<const char *> (value);
             }
 
+            // writes len characters of s without any formatting
+            inline ostream& write (const char *s, size_t len) {
+                __write__ (s, len);
+                __commit__ ();
+                return *this;
+            }
+
 
+            // ranges (containers, arrays, ...) are printed element by element, pairs as first: second, everything else by Print
             template<typename T>
             inline ostream& operator << (const T& value) {
-                Serial.print (value);            
+                __printAny__ (value, __valueKind__<__isRange__<T>::value ? 1 : __isPair__<T>::value ? 2 : 0> ());
+                __commit__ ();
+                return *this;
+            }
+
+            inline ostream& operator << (const rangeFormat_t& rangeFormat) {
+                __rangeFormat__ = rangeFormat;
+                return *this;
+            }
+
+            inline ostream& operator << (const __setw__& w) {
+                __width__ = w.width;
                 return *this;
             }
 
+            inline ostream& operator << (const __setfill__& f) {
+                __fill__ = f.fill;
+                return *this;
+            }
+
+            template<ostreamManipulator fpOutput, int precision, ostreamManipulator grouping, typename T>
+            inline ostream& operator << (const __formatted__<fpOutput, precision, grouping, T>& value) {
+                bool uppercase = __uppercase__; // the exponent is always printed with e
+                __uppercase__ = false;
+                __printValue__ (value.value, fpOutput, precision, grouping == showpoint);
+                __uppercase__ = uppercase;
+                __commit__ ();
+                return *this;
+            }
+
+            // writes the content of the buffer to the output device
+            inline void flush () __attribute__((noinline)) {
+                if (__fixedBuffer__)
+                    return;
+                if (__length__) {
+                    __toSink__ (__buffer__, __length__);
+                    __length__ = 0;
+                }
+                __endOfLine__ = false;
+            }
+
+            #ifdef __STREAM_STATISTICS__
+                inline ostreamStatistics statistics () const { return __statistics__; }
+                inline void resetStatistics () { __statistics__ = {}; }
+            #endif
+
+            // call it from loop () with flushOnIdle policy
+            inline void idle () {
+                if (__length__ && __flushPolicy__ == flushOnIdle && millis () - __lastWrite__ >= __OSTREAM_IDLE_TIMEOUT__)
+                    flush ();
+            }
+
+            // call it from loop () with asynchronous output, it sends as much of the queued output as the device can accept without blocking,
+            // the queue is not synchronized, so service () must run in the same task as the code that writes to the stream (with osyncstream see coutSyncQueue.service ())
+            virtual void service () { idle (); }
+
 
         private:
 
-            inline void __showPointPrintInt__ (char *buf, int len) {
-                int m = (len + 2) % 3;
-                for (int i = 0; i < len; ++i) {
-                    Serial.print (buf [i]);
-                    // print separator every 3 characters
-                    if (i % 3 == m && i < len - 1) {
-                        #ifdef __LOCALE_HPP__
-                            Serial.print (lc_numeric_locale->getThousandsSeparator ());
-                        #else
-                            Serial.print (',');
-                        #endif
+            template<typename T>
+            inline void __printAny__ (const T& value, __valueKind__<0>) {
+                __STREAM_STAT__ (__statistics__.others ++);
+                __bufferPrint__ (this).print (value);
+            }
+
+            // elements go directly to the buffer, nothing is collected in between, so the size of the range doesn't matter
+            template<typename T>
+            inline void __printAny__ (const T& range, __valueKind__<1>) {
+                rangeFormat_t rangeFormat = __rangeFormat__; // nested ranges use the same format
+                __write__ (rangeFormat.open, strlen (rangeFormat.open));
+                size_t count = 0;
+                for (const auto& element : range) {
+                    if (count)
+                        __write__ (rangeFormat.separator, strlen (rangeFormat.separator));
+                    if (rangeFormat.maxElements && count == rangeFormat.maxElements) {
+                        __write__ ("...", 3);
+                        break;
                     }
+                    *this << element;
+                    count ++;
                 }
+                __write__ (rangeFormat.close, strlen (rangeFormat.close));
+            }
+
+            template<typename T>
+            inline void __printAny__ (const T& pair, __valueKind__<2>) {
+                *this << pair.first;
+                __write__ (": ", 2);
+                *this << pair.second;
+            }
+
+            inline void __toSink__ (const char *buf, size_t len) {
+                #ifdef __STREAM_STATISTICS__
+                    unsigned long start = micros ();
+                    __sink__ (buf, len);
+                    __statistics__.sinkMicros += micros () - start;
+                    __statistics__.sinkCalls ++;
+                    __statistics__.bytesWritten += len;
+                #else
+                    __sink__ (buf, len);
+                #endif
             }
 
-            inline void __showPointPrintFloat__ (char *buf) {
-                for (int i = 0;; i++) {
-                    switch (buf [i]) {
-                        case '.':   // decimal separator reached
-                                    __showPointPrintInt__ (buf, i);
-                                    #ifdef __LOCALE_HPP__
-                                        Serial.print (lc_numeric_locale->getDecimalSeparator ());
-                                    #else
-                                        Serial.print ('.');
-                                    #endif
-                                    Serial.print (&buf [i + 1]);
-                                    return;
-                        case 0:     // end of string reached, decimal separator was not present
-                                    __showPointPrintInt__ (buf, i);
-                                    return;
+            inline void __put__ (char c) {
+                if (__length__ == __bufferSize__) {
+                    if (__fixedBuffer__) {
+                        __STREAM_STAT__ (if (!__truncated__) __statistics__.truncations ++);
+                        __truncated__ = true;
+                        return;
+                    }
+                    flush ();
+                }
+                __buffer__ [__length__ ++] = c;
+                if (__fixedBuffer__)
+                    __buffer__ [__length__] = 0;
+                if (c == '\n')
+                    __endOfLine__ = true;
+            }
+
+            inline void __write__ (const char *s, size_t len) __attribute__((noinline)) {
+                if (__fixedBuffer__) {
+                    if (len > __bufferSize__ - __length__) {
+                        len = __bufferSize__ - __length__;
+                        __STREAM_STAT__ (if (!__truncated__) __statistics__.truncations ++);
+                        __truncated__ = true;
+                    }
+                    if (len) {
+                        memcpy (__buffer__ + __length__, s, len);
+                        __length__ += len;
+                        __buffer__ [__length__] = 0;
+                    }
+                    return;
+                }
+                if (len >= __bufferSize__) { // no point in copying it to the buffer
+                    flush ();
+                    __toSink__ (s, len);
+                } else {
+                    if (__length__ + len > __bufferSize__)
+                        flush ();
+                    memcpy (__buffer__ + __length__, s, len);
+                    __length__ += len;
+                }
+                if (__flushPolicy__ == flushOnEndl && memchr (s, '\n', len))
+                    __endOfLine__ = true;
+            }
+
+            // called at the end of each << operation
+            inline void __commit__ () {
+                __width__ = 0; // setw applies only to the next value
+                switch (__flushPolicy__) {
+                    case unitbuf:
+                                    flush ();
+                                    break;
+                    case flushOnEndl:
+                                    if (__endOfLine__)
+                                        flush ();
+                                    break;
+                    case flushOnIdle:
+                                    __lastWrite__ = millis ();
+                                    break;
+                    default:
+                                    break;
+                }
+            }
+
+            // thousands separator insertion while converting digits backwards
+            struct __grouping__ {
+                char separator;     // 0 for no grouping
+                uint8_t size;       // the number of digits in a group
+                uint8_t left;       // digits left to the next separator
+                __grouping__ (char separator, uint8_t size) : separator (size ? separator : 0), size (size), left (size) {}
+            };
+
+            // writes digit c in front of p and inserts thousands separator in front of each full group of digits
+            static inline void __pushDigit__ (char *&p, char c, __grouping__& grouping) {
+                if (grouping.separator) {
+                    if (!grouping.left) {
+                        *-- p = grouping.separator;
+                        grouping.left = grouping.size;
                     }
+                    grouping.left --;
                 }
+                *-- p = c;
             }
 
-            #ifdef __LOCALE_HPP__
-                inline void __localizeSeparators__ (char *buf) {
-                    for (int i = 0; buf [i]; i++) {
-                        switch (buf [i]) {
-                            case '.':   // decimal separator
-                                        buf [i] = lc_numeric_locale->getDecimalSeparator ();
-                                        break;
-                            case ',':   // thousands separator
-                                        buf [i] = lc_numeric_locale->getThousandsSeparator ();
-                                        break;
+            // converts value to decimal digits backwards, from p towards the beginning of the buffer, two digits at a time, producing at least minDigits digits
+            template<typename U>
+            static inline char *__digits__ (char *p, U value, int minDigits, __grouping__& grouping) {
+                while (value >= 100 || minDigits > 2) {
+                    uint8_t r = value % 100;
+                    value /= 100;
+                    __pushDigit__ (p, pgm_read_byte (&__digitPairs__ [2 * r + 1]), grouping);
+                    __pushDigit__ (p, pgm_read_byte (&__digitPairs__ [2 * r]), grouping);
+                    minDigits -= 2;
+                }
+                if (value >= 10 || minDigits == 2) {
+                    __pushDigit__ (p, pgm_read_byte (&__digitPairs__ [2 * value + 1]), grouping);
+                    __pushDigit__ (p, pgm_read_byte (&__digitPairs__ [2 * value]), grouping);
+                } else {
+                    __pushDigit__ (p, '0' + (char) value, grouping);
+                }
+                return p;
+            }
+
+            // converts value to text backwards from the end of the buffer and returns the pointer to its first character, 64 bit values are converted in 32 bit chunks of 8 digits which is much faster on AVR
+            template<typename U>
+            static inline char *__integerToText__ (char *end, bool negative, U value, __grouping__ grouping) {
+                char *p = end;
+                if (sizeof (U) > 4) {
+                    while (value > (U) 0xFFFFFFFF) {
+                        uint32_t chunk = (uint32_t) (value % 100000000);
+                        value /= 100000000;
+                        p = __digits__ (p, chunk, 8, grouping);
+                    }
+                    p = __digits__ (p, (uint32_t) value, 1, grouping);
+                } else {
+                    p = __digits__ (p, value, 1, grouping);
+                }
+                if (negative)
+                    *-- p = lc_numeric_facet.negativeSign;
+                return p;
+            }
+
+            template<typename U>
+            inline void __printInteger__ (bool negative, U value, bool grouping) {
+                __STREAM_STAT__ (__statistics__.integers ++);
+                char buf [40]; // max: -1,8,4,4,6,7,4,4,0,7,3,7,0,9,5,5,1,6,1,5 with grouping of 1 digit
+                char *p = __integerToText__ (buf + sizeof (buf), negative, value, __grouping__ (grouping ? lc_numeric_facet.thousandsSeparator : 0, lc_numeric_facet.grouping));
+                __writePadded__ (p, buf + sizeof (buf) - p);
+            }
+
+            // converts value to hexadecimal, octal or binary digits backwards from the end of the buffer, 64 bit values are converted in 32 (30 for octal) bit chunks which is much faster on AVR
+            template<typename U>
+            static inline char *__bitsToText__ (char *end, U value, uint8_t bitsPerDigit, bool uppercase) {
+                const char *digits = __nibbleDigits__ [uppercase];
+                uint8_t mask = (1 << bitsPerDigit) - 1;
+                char *p = end;
+                if (sizeof (U) > 4) {
+                    uint8_t chunkBits = 32 / bitsPerDigit * bitsPerDigit;
+                    while (value > (U) 0xFFFFFFFF) {
+                        uint32_t chunk = (uint32_t) value & (0xFFFFFFFF >> (32 - chunkBits));
+                        value >>= chunkBits;
+                        for (uint8_t i = 0; i < chunkBits; i += bitsPerDigit) { // all the digits of the chunk, including leading zeros
+                            *-- p = pgm_read_byte (&digits [chunk & mask]);
+                            chunk >>= bitsPerDigit;
                         }
                     }
                 }
-            #endif
+                uint32_t v = (uint32_t) value;
+                do {
+                    *-- p = pgm_read_byte (&digits [v & mask]);
+                    v >>= bitsPerDigit;
+                } while (v);
+                return p;
+            }
+
+            // prints value in hexadecimal, octal or binary base, with the base prefix if showbase is set (except for 0, like printf's # flag)
+            template<typename U>
+            inline void __printBits__ (U value) {
+                __STREAM_STAT__ (__statistics__.integers ++);
+                char buf [2 + 8 * sizeof (U)]; // max: 0b + binary digits
+                char *p = __bitsToText__ (buf + sizeof (buf), value, __base__ == hex ? 4 : __base__ == oct ? 3 : 1, __uppercase__);
+                if (__showbase__ && value) {
+                    if (__base__ != oct)
+                        *-- p = __base__ == hex ? (__uppercase__ ? 'X' : 'x') : (__uppercase__ ? 'B' : 'b');
+                    *-- p = '0';
+                }
+                __writePadded__ (p, buf + sizeof (buf) - p);
+            }
+
+            // integers with the stream settings, U is the unsigned type of the same size as T
+            template<typename T, typename U>
+            inline void __printStreamInteger__ (T value) {
+                if (__base__ == dec)
+                    __printValue__ (value, __fpOutput__, __precision__, __showpoint__);
+                else
+                    __printBits__ ((U) value);
+            }
+
+            // print struct tm and timestamps with the formatter given, see operator << specializations below
+            inline void __printTime__ (timeFormatter& formatter, const struct tm& value);
+            inline void __printTime__ (timeFormatter& formatter, const __timestamp__& value);
+            inline void __printTime__ (timeFormatter& formatter, const __uptime__& value);
+
+            // the same with a temporary formatter, when another task is using the shared one, kept out of line so that it doesn't take stack from the usual path
+            template<typename T>
+            __attribute__((noinline)) void __printTimeUncached__ (const T& value) {
+                timeFormatter formatter;
+                __printTime__ (formatter, value);
+            }
+
+            // writes s padded with the fill character up to the width set by setw
+            inline void __writePadded__ (const char *s, size_t len) {
+                if (__width__ <= (int) len) {
+                    __write__ (s, len);
+                    return;
+                }
+                if (__left__)
+                    __write__ (s, len);
+                __pad__ (len);
+                if (!__left__)
+                    __write__ (s, len);
+            }
+
+            // writes the fill characters that pad a value of len characters to the width set by setw
+            inline void __pad__ (size_t len) {
+                if (__width__ <= (int) len)
+                    return;
+                size_t n = __width__ - len;
+                char padding [16];
+                memset (padding, __fill__, n < sizeof (padding) ? n : sizeof (padding));
+                while (n) {
+                    size_t chunk = n < sizeof (padding) ? n : sizeof (padding);
+                    __write__ (padding, chunk);
+                    n -= chunk;
+                }
+            }
+
+            // writes the exact digits of fixed and scientific output (see __exactDigits__) to the stream in chunks, without storing all of them,
+            // a run of 9s is held back until it is known whether rounding carries into it, and so is everything before the first digit, since a carry may add one
+            struct __fpDigitWriter__ {
+                ostream& os;
+                bool negative;
+                bool fixedLayout;
+                int precision;
+                char thousandsSeparator;    // 0 without grouping
+                int point;                  // the value is 0.digits * 10 ^ point
+                char held;                  // the last digit that is not 9, before the first one '0' stands for the place a carry would put a leading 1 into
+                bool leading;               // held is that '0'
+                int nines;                  // 9s after held
+                int integerDigits;
+                int position;               // digit places written, including the leading zeros of fixed output
+                int total;                  // digit places to write
+                int length;                 // characters of the whole output, for setw
+                char text [24];             // the next chunk of the output
+                uint8_t used;
+
+                __fpDigitWriter__ (ostream& o, bool n, bool f, int p, char t) : os (o), negative (n), fixedLayout (f), precision (p), thousandsSeparator (t), point (1), held ('0'), leading (true), nines (0), used (0) {}
+
+                inline int begin (int p) {
+                    point = p;
+                    return fixedLayout ? point + precision : precision + 1;
+                }
+
+                inline void digit (char d) {
+                    if (d == '9') {
+                        nines ++;
+                    } else {
+                        __release__ (false);
+                        held = d;
+                    }
+                }
+
+                inline void end (int half) {
+                    __release__ (half > 0 || (half == 0 && (nines || (!leading && (held - '0') % 2)))); // round half to even
+                    while (position < total)
+                        __place__ ('0');
+                    if (!fixedLayout) {
+                        if (used > sizeof (text) - 6)
+                            __flush__ ();
+                        used = os.__exponentToText__ (text + used, point - 1) - text;
+                    }
+                    __flush__ ();
+                    if (os.__left__)
+                        os.__pad__ (length);
+                }
+
+                // writes held and the 9s after it, or held + 1 and 0s if rounding carries into them
+                inline void __release__ (bool carry) {
+                    if (leading) {
+                        if (carry) // 9.99 rounded up to 10.0
+                            point ++;
+                        __start__ ();
+                        leading = false;
+                        if (carry)
+                            __place__ ('1');
+                    } else {
+                        __place__ (held + carry);
+                    }
+                    for (; nines; nines --)
+                        __place__ (carry ? '0' : '9');
+                }
+
+                // the position of the decimal point is final now, and so is the length of the output
+                inline void __start__ () {
+                    integerDigits = fixedLayout ? (point > 0 ? point : 0) : 1;
+                    total = integerDigits + precision;
+                    position = 0;
+                    length = negative + (integerDigits ? integerDigits : 1) + (precision ? 1 + precision : 0);
+                    if (thousandsSeparator && integerDigits)
+                        length += (integerDigits - 1) / lc_numeric_facet.grouping;
+                    if (!fixedLayout)
+                        length += point - 1 <= -100 || point - 1 >= 100 ? 5 : 4;
+                    if (!os.__left__)
+                        os.__pad__ (length);
+                    if (negative)
+                        __emit__ (lc_numeric_facet.negativeSign);
+                    if (!integerDigits)
+                        __emit__ ('0');
+                    if (fixedLayout)
+                        for (int i = point; i < 0 && position < total; i++)
+                            __place__ ('0');
+                }
+
+                // writes the digit of the next place, preceded by the decimal or thousands separator where it belongs
+                inline void __place__ (char d) {
+                    if (position == total) // 9.99 rounded up to 10.0 in scientific output, the last 0 doesn't fit
+                        return;
+                    if (position == integerDigits)
+                        __emit__ (lc_numeric_facet.decimalSeparator);
+                    else if (thousandsSeparator && position && position < integerDigits && (integerDigits - position) % lc_numeric_facet.grouping == 0)
+                        __emit__ (thousandsSeparator);
+                    __emit__ (d);
+                    position ++;
+                }
+
+                inline void __emit__ (char c) {
+                    if (used == sizeof (text))
+                        __flush__ ();
+                    text [used ++] = c;
+                }
+
+                inline void __flush__ () {
+                    os.__write__ (text, used);
+                    used = 0;
+                }
+            };
+
+            // prints significand * 2 ^ exponent, using the shortest digits that read back to the same value, fixed and scientific output use exact digits, correctly rounded
+            inline void __printFloatingPoint__ (bool negative, uint64_t significand, int exponent, int significandBits, ostreamManipulator fpOutput, int precision, bool grouping) {
+                if (fpOutput == fixed || fpOutput == scientific)
+                    __printExactDigits__ (negative, significand, exponent, fpOutput == fixed, precision, grouping);
+                else
+                    __printShortestDigits__ (negative, significand, exponent, significandBits);
+            }
+
+            // fixed and scientific output, the two paths are kept out of line separately so that each only takes its own stack
+            inline void __printExactDigits__ (bool negative, uint64_t significand, int exponent, bool fixedLayout, int precision, bool grouping) __attribute__((noinline)) {
+                __fpDigitWriter__ out (*this, negative, fixedLayout, precision, grouping && lc_numeric_facet.grouping ? lc_numeric_facet.thousandsSeparator : 0);
+                if (significand) {
+                    __exactDigits__ (significand, exponent, out);
+                } else {
+                    out.begin (1);
+                    out.end (-1);
+                }
+            }
+
+            // defaultfloat: the shortest representation, exponential notation only for very large or very small numbers
+            inline void __printShortestDigits__ (bool negative, uint64_t significand, int exponent, int significandBits) __attribute__((noinline)) {
+                char text [40]; // the digits (17 at most) start at text + 8, which leaves room for the sign and 0.00000 in front of them
+                char *digits = text + 8;
+                int length = 1;
+                int point = 1; // position of the decimal point relative to the first digit
+                if (significand == 0) {
+                    digits [0] = '0';
+                } else {
+                    int K;
+                    length = __shortestDigits__ (significand, exponent, significandBits, digits, K);
+                    point = length + K;
+                }
+                char decimalSeparator = lc_numeric_facet.decimalSeparator;
+                char *begin = digits;
+                char *end = digits + length;
+                if (point > -6 && point <= 21) {
+                    if (point <= 0) {
+                        begin -= 2 - point;
+                        begin [0] = '0';
+                        begin [1] = decimalSeparator;
+                        memset (begin + 2, '0', -point);
+                    } else if (point < length) {
+                        memmove (digits - 1, digits, point);
+                        digits [point - 1] = decimalSeparator;
+                        begin --;
+                    } else {
+                        memset (end, '0', point - length);
+                        end += point - length;
+                    }
+                } else {
+                    if (length > 1) {
+                        digits [-1] = digits [0];
+                        digits [0] = decimalSeparator;
+                        begin --;
+                    }
+                    end = __exponentToText__ (end, point - 1);
+                }
+                if (negative)
+                    *-- begin = lc_numeric_facet.negativeSign;
+                __writePadded__ (begin, end - begin);
+            }
+
+            // writes the exponent, like e+05 or E-123, to p and returns the end of it
+            inline char *__exponentToText__ (char *p, int e) {
+                unsigned int a = e < 0 ? -e : e;
+                *p ++ = __uppercase__ ? 'E' : 'e';
+                *p ++ = e < 0 ? '-' : '+';
+                if (a >= 100) {
+                    *p ++ = '0' + a / 100;
+                    a %= 100;
+                }
+                *p ++ = '0' + a / 10;
+                *p ++ = '0' + a % 10;
+                return p;
+            }
+
+            // returns true if value was nan or inf and has already been printed
+            inline bool __printNanOrInf__ (bool negative, bool isNan, bool isInf) {
+                if (isNan)
+                    __writePadded__ ("nan", 3);
+                else if (isInf && negative)
+                    __writePadded__ ("-inf", 4);
+                else if (isInf)
+                    __writePadded__ ("inf", 3);
+                else
+                    return false;
+                return true;
+            }
+
+            // the same formatting for values of all types, with the settings given as parameters, so it can be used either with the stream settings or with the compile-time formatted<> ones
+
+            inline void __printValue__ (short value, ostreamManipulator, int, bool grouping) { __printInteger__ (value < 0, (unsigned short) (value < 0 ? 0u - (unsigned short) value : (unsigned short) value), grouping); }
+            inline void __printValue__ (unsigned short value, ostreamManipulator, int, bool grouping) { __printInteger__ (false, value, grouping); }
+            inline void __printValue__ (int value, ostreamManipulator, int, bool grouping) { __printInteger__ (value < 0, value < 0 ? 0u - (unsigned int) value : (unsigned int) value, grouping); }
+            inline void __printValue__ (unsigned int value, ostreamManipulator, int, bool grouping) { __printInteger__ (false, value, grouping); }
+            inline void __printValue__ (long value, ostreamManipulator, int, bool grouping) { __printInteger__ (value < 0, value < 0 ? 0ul - (unsigned long) value : (unsigned long) value, grouping); }
+            inline void __printValue__ (unsigned long value, ostreamManipulator, int, bool grouping) { __printInteger__ (false, value, grouping); }
+            inline void __printValue__ (long long value, ostreamManipulator, int, bool grouping) { __printInteger__ (value < 0, value < 0 ? 0ull - (unsigned long long) value : (unsigned long long) value, grouping); }
+            inline void __printValue__ (unsigned long long value, ostreamManipulator, int, bool grouping) { __printInteger__ (false, value, grouping); }
+
+            inline void __printValue__ (float value, ostreamManipulator fpOutput, int precision, bool grouping) {
+                __STREAM_STAT__ (__statistics__.floatingPoints ++);
+                if (fpOutput == hexfloat) {
+                    #ifdef ARDUINO_ARCH_AVR
+                        __printHexFloat__ (value);
+                    #else
+                        char buf [32];
+                        sprintf (buf, "%a", value); 
+                        // no localization for hexfloat
+                        __writePadded__ (buf, strlen (buf));
+                    #endif
+                    return;
+                }
+                union { float f; uint32_t u; } data;
+                data.f = value;
+                bool negative = data.u >> 31;
+                int biasedExponent = (data.u >> 23) & 0xFF;
+                uint32_t fraction = data.u & 0x7FFFFF;
+                if (__printNanOrInf__ (negative, biasedExponent == 0xFF && fraction, biasedExponent == 0xFF))
+                    return;
+                if (biasedExponent)
+                    __printFloatingPoint__ (negative, fraction | (1ul << 23), biasedExponent - 150, 23, fpOutput, precision, grouping);
+                else
+                    __printFloatingPoint__ (negative, fraction, -149, 23, fpOutput, precision, grouping);
+            }
+
+            inline void __printValue__ (double value, ostreamManipulator fpOutput, int precision, bool grouping) {
+                if (sizeof (double) == 4) { // only 4 bytes on AVR boards
+                    __printValue__ ((float) value, fpOutput, precision, grouping);
+                    return;
+                }
+                __STREAM_STAT__ (__statistics__.floatingPoints ++);
+                if (fpOutput == hexfloat) {
+                    char buf [32];
+                    sprintf (buf, "%a", value); 
+                    // no localization for hexfloat
+                    __writePadded__ (buf, strlen (buf));
+                    return;
+                }
+                union { double d; uint64_t u; } data;
+                data.d = value;
+                bool negative = data.u >> 63;
+                int biasedExponent = (data.u >> 52) & 0x7FF;
+                uint64_t fraction = data.u & 0xFFFFFFFFFFFFFull;
+                if (__printNanOrInf__ (negative, biasedExponent == 0x7FF && fraction, biasedExponent == 0x7FF))
+                    return;
+                if (biasedExponent)
+                    __printFloatingPoint__ (negative, fraction | (1ull << 52), biasedExponent - 1075, 52, fpOutput, precision, grouping);
+                else
+                    __printFloatingPoint__ (negative, fraction, -1074, 52, fpOutput, precision, grouping);
+            }
+
+            inline void __printValue__ (long double value, ostreamManipulator fpOutput, int precision, bool grouping) {
+                if (sizeof (long double) > 4 && fpOutput == hexfloat) {
+                    __STREAM_STAT__ (__statistics__.floatingPoints ++);
+                    char buf [48];
+                    sprintf (buf, "%La", value); 
+                    // no localization for hexfloat
+                    __writePadded__ (buf, strlen (buf));
+                    return;
+                }
+                __printValue__ ((double) value, fpOutput, precision, grouping); // long double is formatted with double precision
+            }
 
             #ifdef ARDUINO_ARCH_AVR
                 inline void __printHexFloat__(float value) {
@@ -181,20 +1558,22 @@
 
                     // handle special cases first
                     if (exp == 0xFF) {
-                        if (frac == 0)
-                            Serial.print ( sign ? "-inf" : "inf" );
-                        else
-                            Serial.print ("nan");
+                        if (frac == 0) {
+                            if (sign) __writePadded__ ("-inf", 4); else __writePadded__ ("inf", 3);
+                        } else {
+                            __writePadded__ ("nan", 3);
+                        }
                         return;
                     } else if (exp == 0 && frac == 0) {
-                        Serial.print ( sign ? "-0x0p+0" : "0x0p+0" );
+                        if (sign) __writePadded__ ("-0x0p+0", 7); else __writePadded__ ("0x0p+0", 6);
                         return;
                     }
 
-                    char buf[40];
-                    int pos = 0;
-
-                    if (sign) Serial.print ("-0x"); else Serial.print ("0x");
+                    char buf [20]; // the whole text, so that setw can pad it
+                    char *q = buf;
+                    if (sign) *q ++ = '-';
+                    *q ++ = '0';
+                    *q ++ = 'x';
 
                     int e;
                     uint32_t mant24;
@@ -231,19 +1610,19 @@
                     }
 
                     // leading part: always '1', dotonly if fraction is not empty
-                    Serial.print ('1');
+                    *q ++ = '1';
                     if (fracbuf [0] != '\0') {
-                        Serial.print ('.');
-                        Serial.print (fracbuf);
+                        *q ++ = '.';
+                        memcpy (q, fracbuf, last + 1);
+                        q += last + 1;
                     }
-                    Serial.print ('p');
-                    if (e >= 0) Serial.print ('+');
-                    char eb [12];
-                    int elen = snprintf (eb, sizeof (eb), "%d", e);
-                    for (int i = 0; i < elen; ++i) Serial.print (eb [i]);
-
-                    buf [pos] = '\0';
-                    Serial.print (buf);
+                    *q ++ = 'p';
+                    if (e >= 0) *q ++ = '+';
+                    char eb [4];
+                    char *p = __integerToText__ (eb + sizeof (eb), e < 0, (unsigned int) (e < 0 ? -e : e), __grouping__ (0, 0));
+                    memcpy (q, p, eb + sizeof (eb) - p);
+                    q += eb + sizeof (eb) - p;
+                    __writePadded__ (buf, q - buf);
                 }
             #endif
     };
@@ -261,279 +1640,254 @@
                                 __showpoint__ = false;
                                 break;
             case fixed:         
+            case scientific:
             case defaultfloat:
             case hexfloat:  
                                 __fpOutput__ = manipulator;
                                 break;
+            case dec:
+            case hex:
+            case oct:
+            case bin:
+                                __base__ = manipulator;
+                                break;
+            case uppercase:
+            case nouppercase:
+                                __uppercase__ = manipulator == uppercase;
+                                break;
+            case showbase:
+            case noshowbase:
+                                __showbase__ = manipulator == showbase;
+                                break;
+            case left:
+            case right:
+                                __left__ = manipulator == left;
+                                break;
+            case endl:
+                                __write__ ("\r\n", 2);
+                                __commit__ ();
+                                break;
+            case ::flush:
+                                ostream::flush ();
+                                break;
             default:            // setprecision 0 - 19
                                 if (manipulator >= 0 && manipulator <= 19) {
                                     __precision__ = (int) manipulator - precision0;
-                                    sprintf (__floatFormat__, "%%.%if", __precision__);
-                                    sprintf (__doubleFormat__, "%%.%ilf", __precision__);
-                                    sprintf (__longDoubleFormat__, "%%.%iLf", __precision__);
                                 }
                                 break;
         }
         return *this;
     }
 
-    // explicit ostream class specializations for integer data types
+    template<>
+    inline ostream& ostream::operator << <ostreamFlushPolicy> (const enum ostreamFlushPolicy& flushPolicy) {
+        __flushPolicy__ = flushPolicy;
+        if (flushPolicy == unitbuf)
+            flush ();
+        return *this;
+    }
 
     template<>
-    inline ostream& ostream::operator << <int16_t> (const int16_t& value) {
-        if (__showpoint__) {
-            char buf [7]; // max: -32768, min: 32767
-            __showPointPrintInt__ (buf, sprintf (buf, "%i", value));
-        } else {
-            Serial.print (value);
-        }
+    inline ostream& ostream::operator << <ostreamOverflowPolicy> (const enum ostreamOverflowPolicy& overflowPolicy) {
+        __overflowPolicy__ = overflowPolicy;
         return *this;
     }
 
+    // explicit ostream class specializations for integer data types (fundamental types are used, since int16_t, int32_t and int64_t are typedefs of different types on different boards)
+
     template<>
-    inline ostream& ostream::operator << <uint16_t> (const uint16_t& value) {
-        if (__showpoint__) {
-            char buf [6]; // max: 65535
-            __showPointPrintInt__ (buf, sprintf (buf, "%u", value));
-        } else {
-            Serial.print (value);
-        }
+    inline ostream& ostream::operator << <char> (const char& value) {
+        __STREAM_STAT__ (__statistics__.others ++);
+        __writePadded__ (&value, 1);
+        __commit__ ();
         return *this;
     }
 
     template<>
-    inline ostream& ostream::operator << <int32_t> (const int32_t& value) {
-        if (__showpoint__) {
-            char buf [12]; // min: -2147483648, max: 2147483647
-            __showPointPrintInt__ (buf, sprintf (buf, "%li", value));
-        } else {
-            Serial.print (value);
-        }
+    inline ostream& ostream::operator << <unsigned char> (const unsigned char& value) { // uint8_t, printed as a number like Print does
+        __printStreamInteger__<unsigned char, unsigned char> (value);
+        __commit__ ();
         return *this;
     }
 
     template<>
-    inline ostream& ostream::operator << <uint32_t> (const uint32_t& value) {
-        if (__showpoint__) {
-            char buf [11]; // max: 4294967295
-            __showPointPrintInt__ (buf, sprintf (buf, "%lu", value));
-        } else {
-            Serial.print (value);
-        }
+    inline ostream& ostream::operator << <short> (const short& value) {
+        __printStreamInteger__<short, unsigned short> (value);
+        __commit__ ();
         return *this;
     }
 
-    #ifdef ARDUINO_ARCH_AVR
-        template<>
-        inline ostream& ostream::operator << <uint64_t> (const uint64_t& value) {
-            if (value == 0) {
-                Serial.print ('0');
-                return *this;
-            }
+    template<>
+    inline ostream& ostream::operator << <unsigned short> (const unsigned short& value) {
+        __printStreamInteger__<unsigned short, unsigned short> (value);
+        __commit__ ();
+        return *this;
+    }
 
-            uint64_t val = value;
-            char buf [21]; // max: 18446744073709551615
-            int i = 20;
-            buf [i --] = 0;
-            while (val > 0) {
-                buf [i--] = '0' + (val % 10);
-                val /= 10;
-            }
-            if (__showpoint__)
-                __showPointPrintInt__ (&buf [i + 1], 20 - i - 1);
-            else
-                Serial.print (&buf [i + 1]);
+    template<>
+    inline ostream& ostream::operator << <int> (const int& value) {
+        __printStreamInteger__<int, unsigned int> (value);
+        __commit__ ();
+        return *this;
+    }
 
-            return *this;
-        }
+    template<>
+    inline ostream& ostream::operator << <unsigned int> (const unsigned int& value) {
+        __printStreamInteger__<unsigned int, unsigned int> (value);
+        __commit__ ();
+        return *this;
+    }
 
-        template<>
-        inline ostream& ostream::operator << <int64_t> (const int64_t& value) {
-            if (value < 0) {
-                Serial.print ('-');
-                ostream::operator << <uint64_t> ((uint64_t) (-(value + 1)) + 1); // convert to uint64_t (considering possible overflow)
-            } else {
-                ostream::operator << <uint64_t> ((uint64_t) value);
-            }
-            return *this;
-        }
-    #else
-        template<>
-        inline ostream& ostream::operator << <int64_t> (const int64_t& value) {
-            if (__showpoint__) {
-                char buf [21]; // min: -9223372036854775808, max: 9223372036854775807
-                __showPointPrintInt__ (buf, sprintf (buf, "%lli", value));
-            } else {
-                Serial.print (value);
-            }
-            return *this;
-        }
+    template<>
+    inline ostream& ostream::operator << <long> (const long& value) {
+        __printStreamInteger__<long, unsigned long> (value);
+        __commit__ ();
+        return *this;
+    }
 
-        template<>
-        inline ostream& ostream::operator << <uint64_t> (const uint64_t& value) {
-            if (__showpoint__) {
-                char buf [21]; // max: 18446744073709551615
-                __showPointPrintInt__ (buf, sprintf (buf, "%llu", value));
-            } else {
-                Serial.print (value);
-            }
-            return *this;
-        }
-    #endif
+    template<>
+    inline ostream& ostream::operator << <unsigned long> (const unsigned long& value) {
+        __printStreamInteger__<unsigned long, unsigned long> (value);
+        __commit__ ();
+        return *this;
+    }
+
+    template<>
+    inline ostream& ostream::operator << <long long> (const long long& value) {
+        __printStreamInteger__<long long, unsigned long long> (value);
+        __commit__ ();
+        return *this;
+    }
+
+    template<>
+    inline ostream& ostream::operator << <unsigned long long> (const unsigned long long& value) {
+        __printStreamInteger__<unsigned long long, unsigned long long> (value);
+        __commit__ ();
+        return *this;
+    }
 
     // explicit ostream class specializations for floats and doubles
 
     template<>
     inline ostream& ostream::operator << <float> (const float& value) {
-        char buf [61]; // min: -3.4028235×10^38, max 60 characters (considering max precision = 19)
-        switch (__fpOutput__) {
-            case defaultfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 0, 2, buf); // default AVR format
-                                #else
-                                    sprintf (buf, "%f", value);                                    
-                                #endif
-                                #ifdef __LOCALE_HPP__
-                                    __localizeSeparators__ (buf);
-                                #endif
-                                Serial.print (buf);
-                                return *this;
-            case fixed:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 1, __precision__, buf);
-                                #else
-                                    snprintf (buf, sizeof (buf), __floatFormat__, value);
-                                #endif
-                                if (__showpoint__) {
-                                    __showPointPrintFloat__ (buf); // takes care of __LOCALE_HPP__ as well
-                                } else {
-                                    #ifdef __LOCALE_HPP__
-                                        __localizeSeparators__ (buf);
-                                    #endif
-                                    Serial.print (buf);
-                                }
-                                return *this;
-            case hexfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    __printHexFloat__ (value);
-                                #else
-                                    sprintf (buf, "%a", value); 
-                                    // no localization for hexfloat
-                                    Serial.print (buf);
-                                #endif
-                                return *this;
-            default:            
-                                break;
-        }
+        __printValue__ (value, __fpOutput__, __precision__, __showpoint__);
+        __commit__ ();
         return *this;
     }
 
     template<>
     inline ostream& ostream::operator << <double> (const double& value) {
-        const int bufSize = (sizeof (double) == 4 /* only 4 bytes on AVR boards */) ? 61 : 331; // min: -1.7976931348623157×10^308 -> max cca 4932 characters (considering max precision = 19)
-        char buf [bufSize];
-        switch (__fpOutput__) {
-            case defaultfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 0, 2, buf); // default AVR format
-                                #else
-                                    sprintf (buf, "%lf", value);                                    
-                                #endif
-                                #ifdef __LOCALE_HPP__
-                                    __localizeSeparators__ (buf);
-                                #endif
-                                Serial.print (buf);
-                                return *this;
-            case fixed:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 1, __precision__, buf);
-                                #else
-                                    snprintf (buf, sizeof (buf), __doubleFormat__, value);
-                                #endif
-                                if (__showpoint__) {
-                                    __showPointPrintFloat__ (buf); // takes care of __LOCALE_HPP__ as well
-                                } else {
-                                    #ifdef __LOCALE_HPP__
-                                        __localizeSeparators__ (buf);
-                                    #endif
-                                    Serial.print (buf);
-                                }
-                                return *this;
-            case hexfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    __printHexFloat__ (value);
-                                #else
-                                    sprintf (buf, "%a", value); 
-                                    // no localization for hexfloat
-                                    Serial.print (buf);
-                                #endif
-                                return *this;
-            default:
-                                break;
-        }
+        __printValue__ (value, __fpOutput__, __precision__, __showpoint__);
+        __commit__ ();
         return *this;
     }
- 
+
     template<>
     inline ostream& ostream::operator << <long double> (const long double& value) {
-        const int bufSize = (sizeof (long double) == 4 /* only 4 bytes on AVR boards */) ? 61 : 331; // min: -1.7976931348623157×10^308 -> max 331 characters (considering max precision = 19)
-        char buf [bufSize];
-        switch (__fpOutput__) {
-            case defaultfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 0, 2, buf); // default AVR format
-                                #else
-                                    sprintf (buf, "%Lf", value);                                    
-                                #endif
-                                #ifdef __LOCALE_HPP__
-                                    __localizeSeparators__ (buf);
-                                #endif
-                                Serial.print (buf);
-                                return *this;
-            case fixed:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    dtostrf (value, 1, __precision__, buf);
-                                #else
-                                    snprintf (buf, sizeof (buf), __longDoubleFormat__, value);
-                                #endif
-                                if (__showpoint__) {
-                                    __showPointPrintFloat__ (buf); // takes care of __LOCALE_HPP__ as well
-                                } else {
-                                    #ifdef __LOCALE_HPP__
-                                        __localizeSeparators__ (buf);
-                                    #endif
-                                    Serial.print (buf);
-                                }
-                                return *this;
-            case hexfloat:
-                                #ifdef ARDUINO_ARCH_AVR
-                                    __printHexFloat__ (value);
-                                #else
-                                    sprintf (buf, "%La", value); 
-                                    // no localization for hexfloat
-                                    Serial.print (buf);
-                                #endif
-                                return *this;
-            default:
-                                break;
-        }
+        __printValue__ (value, __fpOutput__, __precision__, __showpoint__);
+        __commit__ ();
         return *this;
     }
 
-    // explicit ostream class specialization for time_t and struct tm
-    #ifndef ARDUINO_ARCH_AVR 
-        template<>
-        inline ostream& ostream::operator << <struct tm> (const struct tm& value) {
+    // explicit ostream class specializations for struct tm and timestamps
+
+    inline const char *__timeFormat__ () {
+        #ifndef __LOCALE_HPP__
+            return "%Y/%m/%d %T";
+        #else
+            return lc_time_locale->getTimeFormat ();
+        #endif
+    }
+
+    inline void ostream::__printTime__ (timeFormatter& formatter, const struct tm& value) {
+        const char *format = __timeFormat__ ();
+        size_t length;
+        const char *text = formatter.format (format, __tmToFields__ (value), length);
+        #ifndef ARDUINO_ARCH_AVR // strftime is too large for AVR boards
             char buf [80];
-            #ifndef __LOCALE_HPP__
-                strftime (buf, sizeof (buf), "%Y/%m/%d %T", &value);
-            #else
-                strftime (buf, sizeof (buf), lc_time_locale->getTimeFormat (), &value);
-            #endif
-            Serial.print (buf);            
-            return *this;
+            if (!formatter.complete ()) {
+                length = strftime (buf, sizeof (buf), format, &value);
+                text = buf;
+            }
+        #endif
+        __writePadded__ (text, length);
+    }
+
+    inline void ostream::__printTime__ (timeFormatter& formatter, const __timestamp__& value) {
+        const char *format = __timeFormat__ ();
+        size_t length;
+        const char *text = formatter.format (format, value.time, value.millisecond, length);
+        #ifndef ARDUINO_ARCH_AVR
+            char buf [80];
+            if (!formatter.complete ()) {
+                struct tm tm;
+                localtime_r (&value.time, &tm);
+                length = strftime (buf, sizeof (buf), format, &tm);
+                text = buf;
+            }
+        #endif
+        __writePadded__ (text, length);
+    }
+
+    inline void ostream::__printTime__ (timeFormatter& formatter, const __uptime__& value) {
+        unsigned long seconds = value.milliseconds / 1000;
+        __timeFields__ fields = {};
+        fields.hour = seconds / 3600 % 24;
+        fields.minute = seconds / 60 % 60;
+        fields.second = seconds % 60;
+        fields.millisecond = value.milliseconds % 1000;
+        size_t length;
+        const char *text = formatter.format ("%T.%L", fields, length);
+
+        char buf [16 + sizeof ("HH:MM:SS.mmm")]; // days d HH:MM:SS.mmm
+        char *p = buf + sizeof (buf) - length;
+        memcpy (p, text, length);
+        if (seconds >= 86400) {
+            *-- p = ' ';
+            *-- p = 'd';
+            p = __integerToText__ (p, false, seconds / 86400, __grouping__ (0, 0));
         }
-    #endif
+        __writePadded__ (p, buf + sizeof (buf) - p);
+    }
+
+    template<>
+    inline ostream& ostream::operator << <struct tm> (const struct tm& value) {
+        __STREAM_STAT__ (__statistics__.others ++);
+        if (__timeFormatter__.tryLock ()) {
+            __printTime__ (__timeFormatter__, value);
+            __timeFormatter__.unlock ();
+        } else {
+            __printTimeUncached__ (value);
+        }
+        __commit__ ();
+        return *this;
+    }
+
+    template<>
+    inline ostream& ostream::operator << <__timestamp__> (const __timestamp__& value) {
+        __STREAM_STAT__ (__statistics__.others ++);
+        if (__timeFormatter__.tryLock ()) {
+            __printTime__ (__timeFormatter__, value);
+            __timeFormatter__.unlock ();
+        } else {
+            __printTimeUncached__ (value);
+        }
+        __commit__ ();
+        return *this;
+    }
+
+    template<>
+    inline ostream& ostream::operator << <__uptime__> (const __uptime__& value) {
+        __STREAM_STAT__ (__statistics__.others ++);
+        if (__uptimeFormatter__.tryLock ()) {
+            __printTime__ (__uptimeFormatter__, value);
+            __uptimeFormatter__.unlock ();
+        } else {
+            __printTimeUncached__ (value);
+        }
+        __commit__ ();
+        return *this;
+    }
 
     // explicit ostream class specialization for uth8char
     #ifdef __UTF8CHAR__
@@ -560,17 +1914,185 @@
                 u8.__c_str__ [1] = 0; 
             }
 
-            Serial.print (u8.__c_str__);
+            __write__ (u8.__c_str__, strlen (u8.__c_str__));
+            __commit__ ();
             return *this;
         }
     #endif
 
+    // output queue of asynchronous ostream: a ring buffer that gets drained only as fast as the device can accept the data without blocking, the device needs availableForWrite () member function,
+    // writing and draining share the head, tail and count without any locking, so both must be done by the same task (to write from several tasks use osyncstream and drain with coutSyncQueue.service ())
+    template<typename Device, size_t queueSize>
+    class __outputQueue__ {
+
+        public:
+
+            inline void write (Device& device, const char *buf, size_t len, ostreamOverflowPolicy overflowPolicy) {
+                drain (device);
+                if (!__count__ && !__unmarked__ && (size_t) device.availableForWrite () >= len) { // nothing queued and the device has room, no need to copy
+                    device.write ((const uint8_t *) buf, len);
+                    return;
+                }
+                __mark__ ();
+                while (len > queueSize - __count__) {
+                    size_t room = queueSize - __count__;
+                    switch (overflowPolicy) {
+                        case blockWhenFull: // fill the queue and send its oldest part even if it blocks
+                                            __push__ (buf, room);
+                                            buf += room;
+                                            len -= room;
+                                            __send__ (device, __contiguous__ ());
+                                            continue;
+                        case dropOldest:    if (len >= queueSize) { // only the last queueSize bytes survive
+                                                __dropped__ += __count__ + len - queueSize;
+                                                buf += len - queueSize;
+                                                len = queueSize;
+                                                __head__ = __count__ = 0;
+                                            } else {
+                                                __dropped__ += len - room;
+                                                __head__ = (__head__ + len - room) % queueSize;
+                                                __count__ -= len - room;
+                                            }
+                                            continue;
+                        default:            // dropNewest, markDropped
+                                            __dropped__ += len - room;
+                                            if (overflowPolicy == markDropped)
+                                                __unmarked__ += len - room;
+                                            len = room;
+                                            continue;
+                    }
+                }
+                __push__ (buf, len);
+                drain (device);
+            }
+
+            // sends as much of the queue as the device can accept without blocking
+            inline void drain (Device& device) {
+                while (__count__) {
+                    int available = device.availableForWrite ();
+                    if (available <= 0)
+                        break;
+                    size_t n = __contiguous__ ();
+                    __send__ (device, (size_t) available < n ? (size_t) available : n);
+                }
+                __mark__ ();
+            }
+
+            inline size_t pending () const { return __count__; }
+            inline unsigned long dropped () const { return __dropped__; }
+
+        private:
+
+            char __ring__ [queueSize];
+            size_t __head__ = 0;            // the oldest queued byte
+            size_t __count__ = 0;
+            unsigned long __dropped__ = 0;
+            unsigned long __unmarked__ = 0; // dropped bytes not marked in the output yet
+
+            inline size_t __contiguous__ () const { return __head__ + __count__ <= queueSize ? __count__ : queueSize - __head__; }
+
+            inline void __send__ (Device& device, size_t n) {
+                device.write ((const uint8_t *) __ring__ + __head__, n);
+                __head__ = (__head__ + n) % queueSize;
+                __count__ -= n;
+            }
+
+            inline void __push__ (const char *buf, size_t len) {
+                size_t tail = (__head__ + __count__) % queueSize;
+                size_t first = queueSize - tail < len ? queueSize - tail : len;
+                memcpy (__ring__ + tail, buf, first);
+                memcpy (__ring__, buf + first, len - first);
+                __count__ += len;
+            }
+
+            // inserts [... bytes dropped] line into the queue if there is room for it
+            inline void __mark__ () {
+                if (!__unmarked__)
+                    return;
+                char mark [32];
+                char *p = mark + sizeof (mark);
+                const char *text = " bytes dropped]\r\n";
+                p -= strlen (text);
+                memcpy (p, text, strlen (text));
+                unsigned long n = __unmarked__;
+                do {
+                    *-- p = '0' + n % 10;
+                    n /= 10;
+                } while (n);
+                *-- p = '[';
+                *-- p = '\n';
+                *-- p = '\r';
+                size_t len = mark + sizeof (mark) - p;
+                if (len <= queueSize - __count__) {
+                    __push__ (p, len);
+                    __unmarked__ = 0;
+                }
+            }
+    };
+
+    // without the queue the output goes directly to the device
+    template<typename Device>
+    class __outputQueue__<Device, 0> {
+
+        public:
+
+            inline void write (Device& device, const char *buf, size_t len, ostreamOverflowPolicy) { device.write ((const uint8_t *) buf, len); }
+            inline void drain (Device&) {}
+            inline size_t pending () const { return 0; }
+            inline unsigned long dropped () const { return 0; }
+    };
+
+    // ostream that writes to any device with Print-like write (const uint8_t *, size_t) member function (Serial1, WiFiClient, File, ...), for example: basic_ostream<WiFiClient> clientOut (client);
+    // with queueSize > 0 the output is asynchronous, see __OSTREAM_QUEUE_SIZE__
+    template<typename Device, size_t bufferSize = __OSTREAM_BUFFER_SIZE__, size_t queueSize = __OSTREAM_QUEUE_SIZE__>
+    class basic_ostream : public ostream {
+
+        public:
+
+            basic_ostream (Device& device) : ostream (__storage__, bufferSize), __device__ (device) {}
+
+            void service () override {
+                idle ();
+                __queue__.drain (__device__);
+            }
+
+            // the number of bytes waiting in the output queue
+            inline size_t pending () const { return __queue__.pending (); }
+
+            // the number of bytes discarded by dropNewest, dropOldest or markDropped overflow policy
+            inline unsigned long dropped () const { return __queue__.dropped (); }
+
+        private:
+
+            Device& __device__;
+            char __storage__ [bufferSize];
+            __outputQueue__<Device, queueSize> __queue__;
+
+            void __sink__ (const char *buf, size_t len) override {
+                __queue__.write (__device__, buf, len, __overflowPolicy__);
+            }
+    };
+
     // Create a working instances
     #ifdef ARDUINO_ARCH_AVR
-        extern ostream cout;
-        ostream cout;
+        extern basic_ostream<decltype (Serial)> cout;
+        basic_ostream<decltype (Serial)> cout (Serial);
     #else
-        inline ostream cout;
+        inline basic_ostream<decltype (Serial)> cout (Serial);
+    #endif
+
+    // flush cout before cin starts waiting for input
+    #if defined (__ISTREAM_HPP__) && !defined (__CIN_TIE__)
+        #define __CIN_TIE__
+
+        inline void __flushCout__ () { cout.flush (); }
+
+        #ifdef ARDUINO_ARCH_AVR
+            extern bool __cin_tie__;
+            bool __cin_tie__ = (cin.tie (__flushCout__), true);
+        #else
+            inline bool __cin_tie__ = (cin.tie (__flushCout__), true);
+        #endif
     #endif
 
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+ *  osyncstream.hpp for Arduino
+ *
+ *  This file is part of cin, cout library for Arduino: https://github.com/BojanJurca/cin-cout-for-Arduino
+ *
+ *  February 6, 2026, Bojan Jurca
+ *
+ */
+
+
+#ifndef __OSYNCSTREAM_HPP__
+    #define __OSYNCSTREAM_HPP__
+
+    #ifdef ARDUINO_ARCH_AVR
+        #error "osyncstream.hpp is meant for multi-core and RTOS boards, it is not available for AVR boards"
+    #endif
+
+    #include <atomic>
+    #include "ostream.hpp"
+
+
+    // ----- TUNNING PARAMETERS -----
+
+    #ifndef __OSYNCSTREAM_LINE_SIZE__
+        #define __OSYNCSTREAM_LINE_SIZE__ 128   // lines are committed to the target in one piece up to this length
+    #endif
+
+    #ifndef __OSYNCSTREAM_QUEUE_SLOTS__
+        #define __OSYNCSTREAM_QUEUE_SLOTS__ 8   // the number of committed lines that can wait for the target at the same time
+    #endif
+
+
+    // ----- CODE -----
+
+
+    // lock-free multi-producer queue of committed lines (bounded queue with a sequence number in each slot), the producer that finds the target free
+    // becomes the consumer and writes the queued lines to the target, so the lines never interleave and no task ever waits for a mutex
+    class osyncqueue {
+
+        public:
+
+            osyncqueue (ostream& target) : __target__ (target) {
+                for (size_t i = 0; i < __OSYNCSTREAM_QUEUE_SLOTS__; i++)
+                    __slots__ [i].sequence.store (i, std::memory_order_relaxed);
+            }
+
+            // commits buf to the target as one piece, buf is cut to __OSYNCSTREAM_LINE_SIZE__ characters
+            void push (const char *buf, size_t len) {
+                if (len > __OSYNCSTREAM_LINE_SIZE__)
+                    len = __OSYNCSTREAM_LINE_SIZE__;
+                __slot__ *slot;
+                size_t position = __enqueuePosition__.load (std::memory_order_relaxed);
+                while (true) {
+                    slot = &__slots__ [position % __OSYNCSTREAM_QUEUE_SLOTS__];
+                    size_t sequence = slot->sequence.load (std::memory_order_acquire);
+                    intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+                    if (difference == 0) { // free slot, try to reserve it
+                        if (__enqueuePosition__.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                            break;
+                    } else if (difference < 0) { // the queue is full, help emptying it
+                        service ();
+                        #ifdef ARDUINO_ARCH_ESP32
+                            delay (1); // let FreeRTOS run the task that is writing to the target
+                        #else
+                            yield ();
+                        #endif
+                        position = __enqueuePosition__.load (std::memory_order_relaxed);
+                    } else { // another producer has taken the slot
+                        position = __enqueuePosition__.load (std::memory_order_relaxed);
+                    }
+                }
+                memcpy (slot->text, buf, len);
+                slot->length = len;
+                slot->sequence.store (position + 1, std::memory_order_release); // publish
+                service ();
+            }
+
+            // writes the queued lines to the target unless some other task is already doing it, and lets the target service its own output queue,
+            // all the target's work happens under the same flag, so with asynchronous cout call coutSyncQueue.service () instead of cout.service (), which would race with the lines written here
+            void service () {
+                do {
+                    if (__consuming__.exchange (true, std::memory_order_acquire))
+                        return; // the other task will also take what has been queued meanwhile
+                    while (true) {
+                        size_t position = __dequeuePosition__.load (std::memory_order_relaxed);
+                        __slot__& slot = __slots__ [position % __OSYNCSTREAM_QUEUE_SLOTS__];
+                        if (slot.sequence.load (std::memory_order_acquire) != position + 1)
+                            break; // empty
+                        __target__.write (slot.text, slot.length);
+                        slot.sequence.store (position + __OSYNCSTREAM_QUEUE_SLOTS__, std::memory_order_release); // free the slot
+                        __dequeuePosition__.store (position + 1, std::memory_order_relaxed);
+                    }
+                    __target__.flush ();
+                    __target__.service ();
+                    __consuming__.store (false);
+                } while (!__empty__ ()); // a line may have been queued just before the flag was cleared
+            }
+
+        private:
+
+            struct __slot__ {
+                std::atomic<size_t> sequence;
+                size_t length;
+                char text [__OSYNCSTREAM_LINE_SIZE__];
+            };
+
+            ostream& __target__;
+            __slot__ __slots__ [__OSYNCSTREAM_QUEUE_SLOTS__];
+            std::atomic<size_t> __enqueuePosition__ { 0 };
+            std::atomic<size_t> __dequeuePosition__ { 0 };
+            std::atomic<bool> __consuming__ { false };
+
+            inline bool __empty__ () {
+                size_t position = __dequeuePosition__.load ();
+                return __slots__ [position % __OSYNCSTREAM_QUEUE_SLOTS__].sequence.load (std::memory_order_acquire) != position + 1;
+            }
+    };
+
+    // the queue in front of cout, when cout is asynchronous (see __OSTREAM_QUEUE_SIZE__) call coutSyncQueue.service () periodically instead of cout.service ()
+    inline osyncqueue coutSyncQueue (cout);
+
+
+    // ostream with its own line buffer and its own formatting state, each task (or core) uses its own osyncstream instead of cout, the complete line is committed
+    // to the target (cout by default) when endl or '\n' is written, on flush or on destruction, for example:
+    //
+    //    void task (void *) {
+    //        osyncstream out; // task-local
+    //        while (true) {
+    //            out << "core " << xPortGetCoreID () << ": " << fixed << setprecision (2) << measure () << endl;
+    //            ...
+    //        }
+    //    }
+
+    class osyncstream : public ostream {
+
+        public:
+
+            osyncstream (osyncqueue& queue = coutSyncQueue) : ostream (__line__, __OSYNCSTREAM_LINE_SIZE__), __queue__ (queue) {}
+
+            ~osyncstream () { flush (); }
+
+        private:
+
+            osyncqueue& __queue__;
+            char __line__ [__OSYNCSTREAM_LINE_SIZE__];
+
+            // the buffer holds (at most) one line, longer lines are committed in pieces
+            void __sink__ (const char *buf, size_t len) override {
+                while (len) {
+                    size_t n = len < __OSYNCSTREAM_LINE_SIZE__ ? len : __OSYNCSTREAM_LINE_SIZE__;
+                    __queue__.push (buf, n);
+                    buf += n;
+                    len -= n;
+                }
+            }
+    };
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ *  sstream.hpp for Arduino
+ *
+ *  This file is part of cin, cout library for Arduino: https://github.com/BojanJurca/cin-cout-for-Arduino
+ *
+ *  February 6, 2026, Bojan Jurca
+ *
+ */
+
+
+#ifndef __SSTREAM_HPP__
+    #define __SSTREAM_HPP__
+
+    #include "ostream.hpp"
+
+
+    // ----- CODE -----
+
+
+    // ostream that formats into a caller provided char array, it never allocates memory and cuts the output that doesn't fit, for example:
+    //
+    //    char message [64];
+    //    ostringstream os (message, sizeof (message));
+    //    os << "temperature=" << fixed << setprecision (1) << t;
+    //    mqttClient.publish (topic, os.c_str ());
+
+    class ostringstream : public ostream {
+
+        public:
+
+            // size includes the terminating 0, with size 0 there is no room even for that: the ostringstream stays empty, cuts all the output and never touches buffer
+            ostringstream (char *buffer, size_t size) : ostream (size ? buffer : __noBuffer__ (), size ? size - 1 : 0, true) {
+                if (size)
+                    *buffer = 0;
+            }
+
+            // the content, always 0 terminated (ostream writes the 0 after each append)
+            inline const char *c_str () const { return __buffer__; }
+
+            inline const char *str () const { return c_str (); }
+
+            inline size_t length () const { return __length__; }
+
+            // true if some output didn't fit into the char array and has been cut off
+            inline bool truncated () const { return __truncated__; }
+
+            // empties the ostringstream so it can be reused (manipulator settings are kept)
+            inline void reset () {
+                __length__ = 0;
+                __truncated__ = false;
+                if (__bufferSize__) // otherwise the content is "" already
+                    *__buffer__ = 0;
+            }
+
+        private:
+
+            // "" for size 0, it is never written to since nothing fits into it
+            static char *__noBuffer__ () {
+                static char empty = 0;
+                return &empty;
+            }
+
+            void __sink__ (const char *, size_t) override {} // never called, the buffer is the final destination
+    };
+
+
+    // ostringstream with its own char array of N bytes (including the terminating 0)
+    template<size_t N>
+    class fixed_ostringstream : public ostringstream {
+
+        static_assert (N > 0, "fixed_ostringstream<N> expects N > 0, the terminating 0 needs a byte");
+
+        public:
+
+            fixed_ostringstream () : ostringstream (__storage__, N) {}
+
+        private:
+
+            char __storage__ [N];
+    };
+
+#endif